@@ -0,0 +1,33 @@
+//
+// address.cpp - GuestAddress arithmetic benchmarks
+//
+// The Address hierarchy is CRTP precisely so these operations inline down
+// to plain integer arithmetic; a regression here means virtual dispatch or
+// a missed inline crept back in.
+//
+
+#include "vmm/memory/memory.hpp"
+
+#include "bench.hpp"
+
+auto main() -> int
+{
+    using vmm::memory::GuestAddress;
+
+    vmm::bench::run("guest_address_add", [] {
+        auto addr = GuestAddress{0x1234};
+        vmm::bench::keep((addr + 0x1000).data());
+    });
+
+    vmm::bench::run("guest_address_mask", [] {
+        auto addr = GuestAddress{0x12345678};
+        vmm::bench::keep(addr & 0xfff);
+    });
+
+    vmm::bench::run("guest_address_align", [] {
+        auto addr = GuestAddress{0x1234};
+        vmm::bench::keep(addr.align(0x1000).data());
+    });
+
+    return 0;
+}
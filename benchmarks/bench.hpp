@@ -0,0 +1,56 @@
+//
+// bench.hpp - Minimal microbenchmark harness
+//
+
+#pragma once
+
+#include <chrono> // steady_clock, duration_cast, nanoseconds
+#include <cstdint> // uint64_t
+#include <cstdio> // printf
+
+namespace vmm::bench {
+
+// Forces `value` to be materialized without a memory round-trip, defeating
+// constant folding and dead-code elimination inside benchmark loops.
+template<typename T>
+inline auto keep(T&& value) noexcept -> void
+{
+    asm volatile("" : : "g"(value) : "memory");
+}
+
+// Times `op` and prints one JSON line with the name, iteration count, and
+// nanoseconds per operation. One result per line keeps the output
+// machine-readable and diffable between releases.
+//
+// The batch size doubles until the timed section runs for at least 100ms,
+// which both warms the caches and swamps the clock-read overhead.
+template<typename F>
+auto run(const char* name, F op) -> void
+{
+    using clock = std::chrono::steady_clock;
+
+    auto iterations = uint64_t{1};
+
+    for (;;) {
+        const auto start = clock::now();
+
+        for (auto i = uint64_t{}; i < iterations; i++)
+            op();
+
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            clock::now() - start).count();
+
+        if (ns >= 100'000'000) {
+            std::printf("{\"benchmark\": \"%s\", \"iterations\": %llu, "
+                        "\"ns_per_op\": %.2f}\n",
+                        name, static_cast<unsigned long long>(iterations),
+                        static_cast<double>(ns) /
+                            static_cast<double>(iterations));
+            return;
+        }
+
+        iterations *= 2;
+    }
+}
+
+}  // namespace vmm::bench
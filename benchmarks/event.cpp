@@ -0,0 +1,29 @@
+//
+// event.cpp - EventFd round-trip benchmarks
+//
+// A kick costs one eventfd write on the producer and one read on the
+// consumer; this is the floor for any eventfd-based notification path.
+//
+
+#include "vmm/types/event.hpp"
+
+#include "bench.hpp"
+
+auto main() -> int
+{
+    const auto fd = vmm::types::EventFd{};
+
+    vmm::bench::run("eventfd_write_read", [&fd] {
+        fd.write(1);
+        vmm::bench::keep(fd.read());
+    });
+
+    auto value = uint64_t{};
+
+    vmm::bench::run("eventfd_try_write_try_read", [&fd, &value] {
+        vmm::bench::keep(fd.try_write(1).value());
+        vmm::bench::keep(fd.try_read(value).value());
+    });
+
+    return 0;
+}
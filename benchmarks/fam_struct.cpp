@@ -0,0 +1,46 @@
+//
+// fam_struct.cpp - FamStruct construction and copy benchmarks
+//
+// Msrs and Cpuids are built on every vCPU configure path; construction
+// cost tracks the allocation strategy (pooled vs heap) and copy cost the
+// memcpy of the flexible-array payload.
+//
+
+#include "vmm/kvm/kvm.hpp"
+
+#include "bench.hpp"
+
+auto main() -> int
+{
+#if defined(__i386__) || defined(__x86_64__)
+    vmm::bench::run("msrs_construct_64", [] {
+        auto msrs = vmm::kvm::Msrs<64>{};
+        vmm::bench::keep(msrs.data());
+    });
+
+    {
+        auto msrs = vmm::kvm::Msrs<64>{};
+
+        vmm::bench::run("msrs_copy_64", [&msrs] {
+            auto copy = msrs;
+            vmm::bench::keep(copy.data());
+        });
+    }
+
+    vmm::bench::run("cpuids_construct_80", [] {
+        auto cpuids = vmm::kvm::Cpuids<80>{};
+        vmm::bench::keep(cpuids.data());
+    });
+
+    {
+        auto cpuids = vmm::kvm::Cpuids<80>{};
+
+        vmm::bench::run("cpuids_copy_80", [&cpuids] {
+            auto copy = cpuids;
+            vmm::bench::keep(copy.data());
+        });
+    }
+#endif
+
+    return 0;
+}
@@ -0,0 +1,36 @@
+//
+// ioctl.cpp - Ioctl wrapper overhead benchmarks
+//
+// Compares the library's wrapped KVM_GET_API_VERSION against the bare
+// ::ioctl on the same fd. The difference is pure wrapper overhead (PLT
+// call, error translation); it should stay within a handful of
+// nanoseconds of the raw syscall.
+//
+
+#include <fcntl.h> // open, O_RDWR, O_CLOEXEC
+#include <linux/kvm.h> // KVM_GET_API_VERSION
+#include <sys/ioctl.h> // ioctl
+#include <unistd.h> // close
+
+#include "vmm/kvm/kvm.hpp"
+
+#include "bench.hpp"
+
+auto main() -> int
+{
+    const auto kvm = vmm::kvm::System{};
+
+    vmm::bench::run("api_version_wrapped", [&kvm] {
+        vmm::bench::keep(kvm.api_version());
+    });
+
+    const auto fd = open("/dev/kvm", O_RDWR | O_CLOEXEC);
+
+    vmm::bench::run("api_version_raw", [fd] {
+        vmm::bench::keep(::ioctl(fd, KVM_GET_API_VERSION, 0));
+    });
+
+    close(fd);
+
+    return 0;
+}
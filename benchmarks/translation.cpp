@@ -0,0 +1,38 @@
+//
+// translation.cpp - Guest-address translation benchmarks
+//
+// Every MMIO exit and virtio buffer access funnels through
+// GuestMemory::find_region(); this measures the flat sorted index at a
+// realistic region count, plus the typed accessors layered on top.
+//
+
+#include "vmm/memory/memory.hpp"
+
+#include "bench.hpp"
+
+auto main() -> int
+{
+    namespace vm = vmm::memory;
+
+    // Eight regions mirrors a typical small-VM layout (low RAM, MMIO
+    // holes, high RAM, firmware).
+    auto memory = vm::GuestMemory{};
+
+    for (auto i = uint64_t{}; i < 8; i++)
+        memory.insert(vm::GuestMemoryRegion{
+            vm::GuestAddress{0x10000 * (2 * i + 1)}, 0x10000});
+
+    vmm::bench::run("find_region", [&memory] {
+        vmm::bench::keep(memory.find_region(vm::GuestAddress{0x53000}));
+    });
+
+    vmm::bench::run("get_host_address", [&memory] {
+        vmm::bench::keep(memory.get_host_address(vm::GuestAddress{0x53000}));
+    });
+
+    vmm::bench::run("read_obj_u16", [&memory] {
+        vmm::bench::keep(memory.read_obj<uint16_t>(vm::GuestAddress{0x53000}));
+    });
+
+    return 0;
+}
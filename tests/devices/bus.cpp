@@ -0,0 +1,90 @@
+#define CATCH_CONFIG_MAIN
+
+#include <cstring> // memcpy
+#include <memory> // make_shared
+#include <vector> // vector
+
+#include <catch2/catch.hpp>
+
+#include "vmm/devices/devices.hpp"
+
+namespace {
+
+// A byte-addressable scratch register file that records its accesses.
+class ScratchDevice : public vmm::devices::BusDevice
+{
+    public:
+        auto read(uint64_t offset, uint8_t *data, uint32_t size) -> void override
+        {
+            std::memcpy(data, m_bytes.data() + offset, size);
+            reads++;
+        }
+
+        auto write(uint64_t offset, const uint8_t *data, uint32_t size) -> void override
+        {
+            std::memcpy(m_bytes.data() + offset, data, size);
+            writes++;
+        }
+
+        int reads = 0;
+        int writes = 0;
+    private:
+        std::vector<uint8_t> m_bytes = std::vector<uint8_t>(0x100);
+};
+
+}  // namespace
+
+TEST_CASE("Bus dispatch") {
+    auto bus = vmm::devices::Bus{};
+    auto first = std::make_shared<ScratchDevice>();
+    auto second = std::make_shared<ScratchDevice>();
+
+    bus.add(0x1000, 0x100, first);
+    bus.add(0x3000, 0x100, second);
+    REQUIRE(bus.size() == 2);
+
+    // Accesses land on the owning device, offset-relative.
+    auto value = uint8_t{0xab};
+    REQUIRE(bus.write(0x1004, &value, 1));
+    REQUIRE(first->writes == 1);
+    REQUIRE(second->writes == 0);
+
+    value = 0;
+    REQUIRE(bus.read(0x1004, &value, 1));
+    REQUIRE(value == 0xab);
+
+    REQUIRE(bus.write(0x30ff, &value, 1));
+    REQUIRE(second->writes == 1);
+
+    // Unclaimed addresses are reported, not routed: just past the end of
+    // a range, between ranges, and before the first range.
+    REQUIRE_FALSE(bus.read(0x1100, &value, 1));
+    REQUIRE_FALSE(bus.read(0x2000, &value, 1));
+    REQUIRE_FALSE(bus.read(0x0, &value, 1));
+}
+
+TEST_CASE("Bus registration") {
+    auto bus = vmm::devices::Bus{};
+    auto device = std::make_shared<ScratchDevice>();
+
+    bus.add(0x1000, 0x100, device);
+
+    // Empty, wrapping, and overlapping ranges are all rejected.
+    REQUIRE_THROWS_AS(bus.add(0x2000, 0, device), std::invalid_argument);
+    REQUIRE_THROWS_AS(bus.add(0xffffffffffffff00, 0x200, device),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(bus.add(0x10ff, 0x100, device), std::invalid_argument);
+    REQUIRE_THROWS_AS(bus.add(0xf00, 0x101, device), std::invalid_argument);
+
+    // Adjacent ranges are fine.
+    REQUIRE_NOTHROW(bus.add(0x1100, 0x100, device));
+
+    bus.remove(0x1000);
+    REQUIRE(bus.size() == 1);
+
+    auto value = uint8_t{};
+    REQUIRE_FALSE(bus.read(0x1000, &value, 1));
+    REQUIRE(bus.read(0x1100, &value, 1));
+
+    REQUIRE_THROWS_AS(bus.remove(0x1000), std::out_of_range);
+}
@@ -0,0 +1,85 @@
+#define CATCH_CONFIG_MAIN
+
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <catch2/catch.hpp>
+
+#include "vmm/io/io.hpp"
+
+namespace vio = vmm::io;
+namespace vt = vmm::types;
+
+TEST_CASE("IoEngine creation") {
+    REQUIRE_NOTHROW(vio::IoEngine{8});
+}
+
+TEST_CASE("IoEngine batched read/write") {
+    auto engine = vio::IoEngine{8};
+
+    char path[] = "/tmp/libvmm-io-XXXXXX";
+    const auto fd = ::mkstemp(path);
+    REQUIRE(fd >= 0);
+    ::unlink(path);
+
+    const char data[] = "hello, ring";
+    char readback[sizeof(data)] = {};
+
+    // Queue a write, submit, and reap its completion.
+    REQUIRE(engine.queue_write(fd, data, sizeof(data), 0, 1));
+    REQUIRE(engine.pending() == 1);
+    REQUIRE(engine.submit() == 1);
+    REQUIRE(engine.pending() == 0);
+
+    auto completions = std::vector<vio::Completion>{};
+    const auto reap = [&] {
+        while (completions.empty())
+            engine.drain_completions([&](vio::Completion c) {
+                completions.push_back(c);
+            });
+    };
+
+    reap();
+    REQUIRE(completions[0].user_data == 1);
+    REQUIRE(completions[0].result == sizeof(data));
+
+    // Read it back through the ring.
+    completions.clear();
+    REQUIRE(engine.queue_read(fd, readback, sizeof(readback), 0, 2));
+    REQUIRE(engine.submit() == 1);
+
+    reap();
+    REQUIRE(completions[0].user_data == 2);
+    REQUIRE(completions[0].result == sizeof(readback));
+    REQUIRE(std::strcmp(readback, data) == 0);
+
+    ::close(fd);
+}
+
+TEST_CASE("IoEngine completion eventfd") {
+    auto engine = vio::IoEngine{8};
+    auto eventfd = vt::EventFd{EFD_NONBLOCK};
+
+    engine.register_eventfd(eventfd);
+
+    char path[] = "/tmp/libvmm-io-XXXXXX";
+    const auto fd = ::mkstemp(path);
+    REQUIRE(fd >= 0);
+    ::unlink(path);
+
+    const char data[] = "ping";
+    REQUIRE(engine.queue_write(fd, data, sizeof(data), 0, 7));
+    REQUIRE(engine.submit() == 1);
+
+    // The kernel bumps the eventfd once the completion is posted.
+    auto value = uint64_t{};
+    while (eventfd.try_read(value))
+        ;
+    REQUIRE(value == 1);
+
+    REQUIRE(engine.drain_completions([](vio::Completion) {}) == 1);
+
+    ::close(fd);
+}
@@ -1,5 +1,7 @@
 #define CATCH_CONFIG_MAIN
 
+#include <vector>
+
 #include <catch2/catch.hpp>
 
 #include "vmm/kvm/kvm.hpp"
@@ -34,6 +36,34 @@ TEST_CASE("Device creation") {
     REQUIRE_THROWS_WITH(device.get_attr(attr), "Inappropriate ioctl for device");
     REQUIRE_THROWS_WITH(device.set_attr(attr), "Inappropriate ioctl for device");
 }
+
+TEST_CASE("Batched device attributes") {
+    auto kvm = vmm::kvm::System{};
+    auto vm = kvm.vm();
+    auto device = vm.device(KVM_DEV_TYPE_VFIO, KVM_CREATE_DEVICE_TEST);
+
+    // The cached probe never throws; the second call answers from the
+    // cache (same result, no ioctl).
+    REQUIRE_FALSE(device.supports_attr(KVM_DEV_VFIO_GROUP,
+                                       KVM_DEV_VFIO_GROUP_ADD));
+    REQUIRE_FALSE(device.supports_attr(KVM_DEV_VFIO_GROUP,
+                                       KVM_DEV_VFIO_GROUP_ADD));
+
+    // Every entry fails on the test device, and every failure is reported
+    // with its index rather than aborting the batch.
+    auto attrs = std::vector<kvm_device_attr>(2);
+    attrs[0].group = KVM_DEV_VFIO_GROUP;
+    attrs[0].attr = KVM_DEV_VFIO_GROUP_ADD;
+    attrs[1].group = KVM_DEV_VFIO_GROUP;
+    attrs[1].attr = KVM_DEV_VFIO_GROUP_DEL;
+
+    const auto errors = device.set_attrs(attrs);
+
+    REQUIRE(errors.size() == 2);
+    REQUIRE(errors[0].index == 0);
+    REQUIRE(errors[1].index == 1);
+    REQUIRE(errors[0].error == std::errc::inappropriate_io_control_operation);
+}
 #endif
 
 #if defined(__aarch64__)
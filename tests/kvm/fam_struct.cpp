@@ -88,3 +88,33 @@ TEST_CASE("Copy/move FAM struct") {
         //REQUIRE(copy[1] == fam[1]);
     //}
 }
+
+template<std::size_t N>
+using InlineSignalMask = vmm::kvm::detail::InlineFamStruct<&kvm_signal_mask::len,
+                                                           &kvm_signal_mask::sigset, N>;
+
+TEST_CASE("Inline FAM struct") {
+    auto fam = InlineSignalMask<2>{1, 2};
+
+    REQUIRE(fam.size() == 2);
+    REQUIRE(fam.capacity() == 2);
+    REQUIRE(fam[0] == 1);
+    REQUIRE(fam[1] == 2);
+
+    // The backing storage is a member, not a heap block.
+    const auto begin = reinterpret_cast<const char*>(&fam);
+    const auto end = begin + sizeof(fam);
+    const auto data = reinterpret_cast<const char*>(fam.data());
+
+    REQUIRE(data >= begin);
+    REQUIRE(data < end);
+
+    SECTION("Copy") {
+        auto copy{fam};
+
+        REQUIRE(copy.size() == fam.size());
+        REQUIRE(copy[0] == fam[0]);
+        REQUIRE(copy[1] == fam[1]);
+        REQUIRE(copy.data() != fam.data());
+    }
+}
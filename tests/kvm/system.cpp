@@ -97,6 +97,22 @@ TEST_CASE("Cpuids") {
         //}
     //}
 }
+
+TEST_CASE("Feature snapshot") {
+    auto kvm = vmm::kvm::System{};
+
+    const auto& features = kvm.features();
+
+    // Built once; later calls return the same snapshot.
+    REQUIRE(&kvm.features() == &features);
+
+    REQUIRE(features.supported_cpuids.size() <= MAX_CPUID_ENTRIES);
+    REQUIRE(features.msr_indices.size() <= MAX_IO_MSRS);
+
+    // Stamped copies come from the cache, not a fresh ioctl.
+    auto cpuids = kvm.vcpu_cpuids();
+    REQUIRE(cpuids.size() == features.supported_cpuids.size());
+}
 #endif
 
 #if defined(__arm__) || defined(__aarch64__)
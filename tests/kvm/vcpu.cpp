@@ -1,6 +1,8 @@
 #define CATCH_CONFIG_MAIN
 
 #include <bitset> // bitset
+#include <thread> // thread
+
 #include <catch2/catch.hpp>
 
 #include <string.h> // memcmp
@@ -25,6 +27,36 @@ TEST_CASE("Immediate exit") {
         REQUIRE(vcpu.immediate_exit() == 1);
 }
 
+TEST_CASE("Cross-thread kick") {
+    auto kvm = vmm::kvm::System{};
+    auto vm = kvm.vm();
+    auto vcpu = vm.vcpu(0);
+
+    REQUIRE_NOTHROW(vmm::kvm::Vcpu::setup_kick_signal());
+
+    // A kick before the vCPU ever runs arms the immediate-exit flag and
+    // records why; the signal step is skipped since no thread is attached.
+    auto kicker = std::thread{[&vcpu] {
+        vcpu.kick(vmm::kvm::VCPU_KICK_PAUSE);
+    }};
+    kicker.join();
+
+    REQUIRE(vcpu.immediate_exit() == 1);
+    REQUIRE(vcpu.pending() == vmm::kvm::VCPU_KICK_PAUSE);
+
+    // Draining returns the work, rearms the flag, and leaves nothing behind.
+    REQUIRE(vcpu.take_pending() == vmm::kvm::VCPU_KICK_PAUSE);
+    REQUIRE(vcpu.immediate_exit() == 0);
+    REQUIRE(vcpu.pending() == 0);
+    REQUIRE(vcpu.take_pending() == 0);
+
+    // Kicks accumulate bitwise until drained.
+    vcpu.kick();
+    vcpu.kick(vmm::kvm::VCPU_KICK_USER);
+    REQUIRE(vcpu.take_pending() ==
+            (vmm::kvm::VCPU_KICK_WAKE | vmm::kvm::VCPU_KICK_USER));
+}
+
 #if defined(__i386__) || defined(__x86_64__) || \
     defined(__arm__)  || defined(__aarch64__)
 TEST_CASE("Multi-processing state") {
@@ -446,3 +478,53 @@ TEST_CASE("Run (x86)") {
     }
 }
 #endif
+
+#if defined(VMM_VCPU_STATS)
+TEST_CASE("Exit statistics") {
+    // The statistics slot is exercisable without running a guest: record()
+    // and snapshot() are exactly what Vcpu::run() and a monitor call.
+    auto stats = vmm::kvm::VcpuStats{};
+
+    const auto io = static_cast<std::size_t>(vmm::kvm::VcpuExit::Io);
+    const auto hlt = static_cast<std::size_t>(vmm::kvm::VcpuExit::Hlt);
+
+    stats.record(vmm::kvm::VcpuExit::Io, 100);
+    stats.record(vmm::kvm::VcpuExit::Io, 100);
+    stats.record(vmm::kvm::VcpuExit::Hlt, 5000);
+
+    auto snapshot = stats.snapshot();
+    REQUIRE(snapshot.exits[io] == 2);
+    REQUIRE(snapshot.exits[hlt] == 1);
+
+    // Latency histograms stay empty until enabled.
+    REQUIRE(snapshot.latency[io][6] == 0);
+
+    stats.set_latency_enabled(true);
+    stats.record(vmm::kvm::VcpuExit::Io, 100);
+
+    snapshot = stats.snapshot();
+    REQUIRE(snapshot.exits[io] == 3);
+    REQUIRE(snapshot.latency[io][6] == 1);  // 100ns -> bucket log2(100)
+}
+#endif
+
+#if defined(__i386__) || defined(__x86_64__)
+TEST_CASE("Checkpoint round-trip") {
+    auto kvm = vmm::kvm::System{};
+    auto vm = kvm.vm();
+    auto vcpus = vm.vcpus(2);
+
+    const auto indices = kvm.msr_index_list();
+    const auto states = vmm::kvm::save_vcpus(vcpus, indices);
+
+    REQUIRE(states.size() == 2);
+    REQUIRE(states[0].nmsrs > 0);
+
+    // A state buffer is self-contained: restoring the captured states onto
+    // the same vCPUs must round-trip the register file exactly.
+    vmm::kvm::restore_vcpus(vcpus, states);
+
+    const auto regs = vcpus[0].regs();
+    REQUIRE(memcmp(&regs, &states[0].regs, sizeof(regs)) == 0);
+}
+#endif
@@ -1,5 +1,7 @@
 #define CATCH_CONFIG_MAIN
 
+#include <algorithm>
+
 #include <catch2/catch.hpp>
 #include "vmm/kvm/kvm.hpp"
 
@@ -33,6 +35,22 @@ TEST_CASE("vCPU creation") {
     }
 }
 
+TEST_CASE("Bulk vCPU creation") {
+    auto kvm = vmm::kvm::System{};
+    auto vm = kvm.vm();
+
+    const auto count = std::min(kvm.check_extension(KVM_CAP_MAX_VCPUS), 8);
+    const auto vcpus = vm.vcpus(count);
+
+    REQUIRE(vcpus.size() == static_cast<std::size_t>(count));
+
+    // Ids past the ones handed out above are still creatable.
+    if (count < kvm.check_extension(KVM_CAP_MAX_VCPUS))
+        REQUIRE_NOTHROW(vm.vcpu(count));
+
+    REQUIRE(vm.vcpus(0).empty());
+}
+
 TEST_CASE("Empty memory region") {
     auto kvm = vmm::kvm::System{};
     auto vm = kvm.vm();
@@ -200,6 +218,41 @@ TEST_CASE("GSI routing") {
     }
 }
 
+TEST_CASE("Incremental GSI routing") {
+    auto kvm = vmm::kvm::System{};
+    auto vm = kvm.vm();
+
+    if (vm.check_extension(KVM_CAP_IRQ_ROUTING) > 0) {
+        vm.irqchip();
+
+        auto manager = vmm::kvm::GsiRoutingManager<16>{vm};
+
+        auto entry = kvm_irq_routing_entry{};
+        entry.gsi = 5;
+        entry.type = KVM_IRQ_ROUTING_MSI;
+
+        manager.set(entry);
+        REQUIRE(manager.dirty());
+        REQUIRE(manager.size() == 1);
+        REQUIRE(manager.route(5) != nullptr);
+        REQUIRE(manager.route(4) == nullptr);
+
+        // Rewriting an identical entry stays clean after a flush.
+        REQUIRE(manager.flush());
+        REQUIRE(!manager.dirty());
+        manager.set(entry);
+        REQUIRE(!manager.flush());
+
+        // A burst of changes coalesces into one submission.
+        entry.u.msi.address_lo = 0xfee00000;
+        manager.set(entry);
+        REQUIRE(manager.remove(5));
+        REQUIRE(!manager.remove(5));
+        REQUIRE(manager.flush());
+        REQUIRE(manager.size() == 0);
+    }
+}
+
 TEST_CASE("IRQ line") {
     auto kvm = vmm::kvm::System{};
     auto vm = kvm.vm();
@@ -16,19 +16,19 @@ class TestAddress : public vmm::memory::Address<TestAddress, uint64_t>
     public:
         explicit TestAddress(size_type addr=0) noexcept : m_addr{addr} {}
 
-        auto data() const noexcept -> size_type override { return m_addr; }
+        auto data() const noexcept -> size_type { return m_addr; }
 
-        auto operator&(const size_type mask) const noexcept -> size_type override { return m_addr & mask; }
-        auto operator|(const size_type mask) const noexcept -> size_type override { return m_addr | mask; }
-        auto operator+(const size_type val) const noexcept -> value_type override { return TestAddress{m_addr + val}; }
-        auto operator+(const_reference addr) const noexcept -> value_type override { return *this + addr.data(); }
-        auto operator-(const size_type val) const noexcept -> value_type override { return TestAddress{m_addr - val}; }
-        auto operator-(const_reference addr) const noexcept -> value_type override { return *this - addr.data(); }
+        auto operator&(const size_type mask) const noexcept -> size_type { return m_addr & mask; }
+        auto operator|(const size_type mask) const noexcept -> size_type { return m_addr | mask; }
+        auto operator+(const size_type val) const noexcept -> value_type { return TestAddress{m_addr + val}; }
+        auto operator+(const_reference addr) const noexcept -> value_type { return *this + addr.data(); }
+        auto operator-(const size_type val) const noexcept -> value_type { return TestAddress{m_addr - val}; }
+        auto operator-(const_reference addr) const noexcept -> value_type { return *this - addr.data(); }
 
         auto operator==(const_reference addr) const noexcept -> bool { return m_addr == addr.data(); }
         auto operator!=(const_reference addr) const noexcept -> bool { return m_addr != addr.data(); }
 
-        auto align(const size_type alignment) noexcept -> reference override
+        auto align(const size_type alignment) noexcept -> reference
 		{
             const auto mask = alignment - 1;
             m_addr = (*this + mask) & ~mask;
@@ -0,0 +1,68 @@
+#define CATCH_CONFIG_MAIN
+
+#include <catch2/catch.hpp>
+
+#include "vmm/memory/memory.hpp"
+
+namespace vm = vmm::memory;
+
+namespace {
+
+constexpr auto page_size = uint64_t{0x1000};
+
+auto scan(const std::vector<uint64_t>& bitmap) -> std::vector<vm::DirtyRange>
+{
+    return vm::scan_dirty_bitmap(bitmap, vm::GuestAddress{}, page_size);
+}
+
+}  // namespace
+
+TEST_CASE("Clean bitmap") {
+    REQUIRE(scan({}).empty());
+    REQUIRE(scan(std::vector<uint64_t>(64, 0)).empty());
+}
+
+TEST_CASE("Single dirty page") {
+    const auto ranges = scan({uint64_t{1} << 9});
+
+    REQUIRE(ranges.size() == 1);
+    REQUIRE(ranges[0].start.data() == 9 * page_size);
+    REQUIRE(ranges[0].len == page_size);
+}
+
+TEST_CASE("Adjacent pages coalesce") {
+    // Pages 62-65: a run crossing a word boundary.
+    const auto ranges = scan({uint64_t{3} << 62, uint64_t{3}});
+
+    REQUIRE(ranges.size() == 1);
+    REQUIRE(ranges[0].start.data() == 62 * page_size);
+    REQUIRE(ranges[0].len == 4 * page_size);
+}
+
+TEST_CASE("Separate runs stay separate") {
+    auto bitmap = std::vector<uint64_t>(16, 0);
+    bitmap[0] = 0b1011;         // pages 0-1 and 3
+    bitmap[8] = ~uint64_t{};    // pages 512-575
+
+    const auto ranges = scan(bitmap);
+
+    REQUIRE(ranges.size() == 3);
+    REQUIRE(ranges[0].start.data() == 0);
+    REQUIRE(ranges[0].len == 2 * page_size);
+    REQUIRE(ranges[1].start.data() == 3 * page_size);
+    REQUIRE(ranges[1].len == page_size);
+    REQUIRE(ranges[2].start.data() == 512 * page_size);
+    REQUIRE(ranges[2].len == 64 * page_size);
+}
+
+TEST_CASE("Base address offsets ranges") {
+    auto ranges = std::vector<vm::DirtyRange>{};
+    const auto bitmap = std::vector<uint64_t>{uint64_t{1}};
+
+    const auto n = vm::scan_dirty_bitmap(bitmap.data(), bitmap.size(),
+                                         vm::GuestAddress{0x100000},
+                                         page_size, ranges);
+
+    REQUIRE(n == 1);
+    REQUIRE(ranges[0].start.data() == 0x100000);
+}
@@ -1,8 +1,261 @@
 #define CATCH_CONFIG_MAIN
 
+#include <cstring>
+#include <vector>
+
+#include <sys/mman.h> // mincore
+#include <unistd.h> // close, unlink
+
 #include <catch2/catch.hpp>
 
 #include "vmm/memory/guest.hpp"
 
-TEST_CASE("vCPU creation") {
+namespace vm = vmm::memory;
+
+TEST_CASE("Guest memory region") {
+    const auto region = vm::GuestMemoryRegion{vm::GuestAddress{0x1000}, 0x1000};
+
+    REQUIRE(region.start().data() == 0x1000);
+    REQUIRE(region.last().data() == 0x1fff);
+    REQUIRE(region.size() == 0x1000);
+    REQUIRE(region.data() != nullptr);
+
+    REQUIRE(region.contains(vm::GuestAddress{0x1000}));
+    REQUIRE(region.contains(vm::GuestAddress{0x1fff}));
+    REQUIRE(!region.contains(vm::GuestAddress{0xfff}));
+    REQUIRE(!region.contains(vm::GuestAddress{0x2000}));
+
+    REQUIRE(region.get_host_address(vm::GuestAddress{0x1010}) ==
+            static_cast<unsigned char*>(region.data()) + 0x10);
+    REQUIRE(region.get_host_address(vm::GuestAddress{0x2000}) == nullptr);
+}
+
+TEST_CASE("Empty guest memory region") {
+    REQUIRE_THROWS(vm::GuestMemoryRegion{vm::GuestAddress{}, 0});
+}
+
+TEST_CASE("Guest memory translation") {
+    auto memory = vm::GuestMemory{};
+
+    REQUIRE(memory.empty());
+    REQUIRE(memory.find_region(vm::GuestAddress{0}) == nullptr);
+
+    // Inserted out of order; the index keeps itself sorted.
+    memory.insert(vm::GuestMemoryRegion{vm::GuestAddress{0x8000}, 0x1000});
+    memory.insert(vm::GuestMemoryRegion{vm::GuestAddress{0x1000}, 0x1000});
+    memory.insert(vm::GuestMemoryRegion{vm::GuestAddress{0x4000}, 0x2000});
+
+    REQUIRE(memory.size() == 3);
+    REQUIRE(memory.region(0).start().data() == 0x1000);
+    REQUIRE(memory.region(2).start().data() == 0x8000);
+
+    const auto region = memory.find_region(vm::GuestAddress{0x5000});
+    REQUIRE(region != nullptr);
+    REQUIRE(region->start().data() == 0x4000);
+
+    // Holes between regions and addresses past the last region miss.
+    REQUIRE(memory.find_region(vm::GuestAddress{0xfff}) == nullptr);
+    REQUIRE(memory.find_region(vm::GuestAddress{0x3000}) == nullptr);
+    REQUIRE(memory.find_region(vm::GuestAddress{0x9000}) == nullptr);
+
+    const auto host = memory.get_host_address(vm::GuestAddress{0x4010});
+    REQUIRE(host == static_cast<unsigned char*>(region->data()) + 0x10);
+    REQUIRE(memory.get_host_address(vm::GuestAddress{0x3000}) == nullptr);
+}
+
+TEST_CASE("Typed guest memory access") {
+    struct Header
+    {
+        uint64_t addr;
+        uint32_t len;
+        uint16_t flags;
+        uint16_t next;
+    };
+
+    static_assert(vm::is_byte_valued_v<Header>);
+
+    auto memory = vm::GuestMemory{};
+    memory.insert(vm::GuestMemoryRegion{vm::GuestAddress{0x1000}, 0x1000});
+
+    const auto value = Header{0xdeadbeef, 64, 3, 7};
+    memory.write_obj(vm::GuestAddress{0x1010}, value);
+
+    // The bytes land in place in the mapped region.
+    auto raw = Header{};
+    std::memcpy(&raw,
+                memory.get_host_address(vm::GuestAddress{0x1010}),
+                sizeof(raw));
+    REQUIRE(raw.addr == value.addr);
+
+    const auto copy = memory.read_obj<Header>(vm::GuestAddress{0x1010});
+    REQUIRE(copy.addr == value.addr);
+    REQUIRE(copy.len == value.len);
+    REQUIRE(copy.flags == value.flags);
+    REQUIRE(copy.next == value.next);
+
+    // Unaligned access is allowed.
+    memory.write_obj(vm::GuestAddress{0x1013}, uint32_t{0xabcd});
+    REQUIRE(memory.read_obj<uint32_t>(vm::GuestAddress{0x1013}) == 0xabcd);
+
+    // Unmapped addresses and objects running off the end of a region throw.
+    REQUIRE_THROWS(memory.read_obj<uint32_t>(vm::GuestAddress{0x3000}));
+    REQUIRE_THROWS(memory.read_obj<uint32_t>(vm::GuestAddress{0x1ffd}));
+    REQUIRE_THROWS(memory.write_obj(vm::GuestAddress{0x1fff}, uint16_t{1}));
+    REQUIRE_NOTHROW(memory.read_obj<uint16_t>(vm::GuestAddress{0x1ffe}));
+}
+
+TEST_CASE("Overlapping guest memory regions") {
+    auto memory = vm::GuestMemory{};
+    memory.insert(vm::GuestMemoryRegion{vm::GuestAddress{0x1000}, 0x2000});
+
+    REQUIRE_THROWS(memory.insert(vm::GuestMemoryRegion{vm::GuestAddress{0x2fff}, 0x1000}));
+    REQUIRE_THROWS(memory.insert(vm::GuestMemoryRegion{vm::GuestAddress{0x500}, 0x1000}));
+}
+
+TEST_CASE("Region backing policies") {
+    constexpr auto huge_2m = vm::backing_page_size(vm::Backing::HugeTlb2M);
+
+    SECTION("Default backing") {
+        const auto region = vm::GuestMemoryRegion{vm::GuestAddress{0x1000},
+                                                  0x1000};
+        REQUIRE(region.backing() == vm::Backing::Default);
+    }
+
+    SECTION("Transparent hugepages") {
+        auto start = vm::GuestAddress{0x1234};
+        start.align(huge_2m);
+        REQUIRE(start.data() == huge_2m);
+
+        const auto region = vm::GuestMemoryRegion{start, huge_2m,
+                                                  vm::Backing::TransparentHuge};
+        REQUIRE(region.backing() == vm::Backing::TransparentHuge);
+        REQUIRE(region.size() == huge_2m);
+    }
+
+    SECTION("Alignment is enforced") {
+        // Unaligned start and unaligned size both fail up front.
+        REQUIRE_THROWS(vm::GuestMemoryRegion{vm::GuestAddress{0x1000}, huge_2m,
+                                             vm::Backing::HugeTlb2M});
+        REQUIRE_THROWS(vm::GuestMemoryRegion{vm::GuestAddress{huge_2m}, 0x1000,
+                                             vm::Backing::HugeTlb2M});
+    }
+
+    SECTION("Explicit hugetlb pages") {
+        // Succeeds only when the host has free pages in the 2M pool; a
+        // depleted pool must fail fast rather than fault later.
+        try {
+            const auto region = vm::GuestMemoryRegion{vm::GuestAddress{huge_2m},
+                                                      huge_2m,
+                                                      vm::Backing::HugeTlb2M};
+            REQUIRE(region.backing() == vm::Backing::HugeTlb2M);
+        }
+        catch (const std::system_error&) {
+            // Host has no hugetlb pages reserved.
+        }
+    }
+}
+
+TEST_CASE("Shared memfd-backed region") {
+    auto region = vm::GuestMemoryRegion::shared(vm::GuestAddress{0x1000},
+                                                0x2000);
+
+    REQUIRE(region.shared_fd() >= 0);
+    REQUIRE(region.size() == 0x2000);
+    REQUIRE(region.data() != nullptr);
+
+    // The seal holds: the backing file cannot shrink under a backend that
+    // already mapped it.
+    REQUIRE(ftruncate(region.shared_fd(), 0x1000) == -1);
+
+    // A second mapping of the fd sees writes through the region — the
+    // zero-copy property a vhost-user backend relies on.
+    const auto other = mmap(nullptr, 0x2000, PROT_READ, MAP_SHARED,
+                            region.shared_fd(), 0);
+    REQUIRE(other != MAP_FAILED);
+
+    static_cast<unsigned char*>(region.data())[42] = 0xaa;
+    REQUIRE(static_cast<const unsigned char*>(other)[42] == 0xaa);
+    munmap(other, 0x2000);
+
+    // Anonymous regions have no fd to export.
+    const auto anon = vm::GuestMemoryRegion{vm::GuestAddress{0x1000}, 0x1000};
+    REQUIRE(anon.shared_fd() == -1);
+}
+
+TEST_CASE("NUMA placement") {
+    // Node 0 exists on every Linux host, NUMA or not.
+    const auto cpus = vm::node_cpus(0);
+    REQUIRE(!cpus.empty());
+    REQUIRE_THROWS(vm::node_cpus(4096));
+
+    const auto region = vm::GuestMemoryRegion{vm::GuestAddress{0x1000}, 0x4000};
+    REQUIRE_NOTHROW(region.bind_to_node(0));
+    REQUIRE_NOTHROW(region.interleave(uint64_t{1} << 0));
+    REQUIRE_THROWS(region.bind_to_node(64));
+    REQUIRE_THROWS(region.interleave(0));
+
+    REQUIRE_NOTHROW(vm::pin_current_thread_to_node(0));
+}
+
+TEST_CASE("Parallel prefault") {
+    auto memory = vm::GuestMemory{};
+    memory.insert(vm::GuestMemoryRegion{vm::GuestAddress{0x10000}, 0x8000});
+    memory.insert(vm::GuestMemoryRegion{vm::GuestAddress{0x20000}, 0x4000});
+
+    REQUIRE_NOTHROW(memory.prefault(2));
+
+    // Every backing page is resident afterwards.
+    for (auto i = std::size_t{}; i < memory.size(); i++) {
+        const auto& region = memory.region(i);
+        const auto pages = region.size() / 0x1000;
+
+        auto resident = std::vector<unsigned char>(pages);
+        REQUIRE(::mincore(region.data(), region.size(), resident.data()) == 0);
+
+        for (const auto page : resident)
+            REQUIRE((page & 1) == 1);
+    }
+}
+
+TEST_CASE("File offset backend") {
+    char path[] = "/tmp/libvmm-file-XXXXXX";
+    const auto fd = ::mkstemp(path);
+    REQUIRE(fd >= 0);
+    ::close(fd);
+
+    const char data[] = "backing file contents";
+
+    {
+        // Transfers are positional and relative to the starting point.
+        const auto file = vm::FileOffset{path, 0x100};
+        REQUIRE(file.start() == 0x100);
+        REQUIRE(file.write(data, sizeof(data)) == sizeof(data));
+
+        char readback[sizeof(data)] = {};
+        REQUIRE(file.read(readback, sizeof(readback)) == sizeof(readback));
+        REQUIRE(std::strcmp(readback, data) == 0);
+
+        // Nothing landed before the starting point.
+        char head = 'x';
+        REQUIRE(file.read(&head, 1, -0x100) == 1);
+        REQUIRE(head == '\0');
+    }
+
+    SECTION("O_DIRECT with an aligned buffer") {
+        auto buffer = vm::AlignedBuffer{100};
+        REQUIRE(buffer.size() == vm::AlignedBuffer::DIRECT_IO_ALIGNMENT);
+        REQUIRE(reinterpret_cast<uintptr_t>(buffer.data()) %
+                vm::AlignedBuffer::DIRECT_IO_ALIGNMENT == 0);
+
+        // Not every filesystem supports O_DIRECT (tmpfs notably).
+        try {
+            const auto file = vm::FileOffset{path, 0, true};
+            std::memset(buffer.data(), 0x5a, buffer.size());
+            REQUIRE(file.write(buffer.data(), buffer.size()) == buffer.size());
+        }
+        catch (const std::system_error&) {
+        }
+    }
+
+    ::unlink(path);
 }
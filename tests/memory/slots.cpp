@@ -0,0 +1,123 @@
+#define CATCH_CONFIG_MAIN
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include <catch2/catch.hpp>
+
+#include "vmm/memory/guest.hpp"
+
+namespace vm = vmm::memory;
+
+TEST_CASE("Memslot generations") {
+    auto manager = vm::MemslotManager{};
+
+    REQUIRE(manager.epoch() == 0);
+    REQUIRE(manager.view()->empty());
+
+    const auto region = manager.insert(
+        vm::GuestMemoryRegion{vm::GuestAddress{0x1000}, 0x1000});
+
+    REQUIRE(manager.epoch() == 1);
+
+    const auto view = manager.view();
+
+    REQUIRE(view->epoch() == 1);
+    REQUIRE(view->size() == 1);
+    REQUIRE(view->find_region(vm::GuestAddress{0x1800}) == region.get());
+    REQUIRE(view->find_region(vm::GuestAddress{0x2000}) == nullptr);
+    REQUIRE(view->get_host_address(vm::GuestAddress{0x1010}) ==
+            static_cast<unsigned char*>(region->data()) + 0x10);
+
+    // A failed insert publishes nothing.
+    REQUIRE_THROWS(manager.insert(
+        vm::GuestMemoryRegion{vm::GuestAddress{0x1800}, 0x1000}));
+    REQUIRE(manager.epoch() == 1);
+
+    view->write_obj(vm::GuestAddress{0x1000}, uint32_t{0xcafe});
+    REQUIRE(view->read_obj<uint32_t>(vm::GuestAddress{0x1000}) == 0xcafe);
+}
+
+TEST_CASE("Removed memslots retire with their last view") {
+    auto manager = vm::MemslotManager{};
+
+    manager.insert(vm::GuestMemoryRegion{vm::GuestAddress{0x1000}, 0x1000});
+
+    const auto old_view = manager.view();
+
+    REQUIRE(manager.remove(vm::GuestAddress{0x1000}));
+    REQUIRE_FALSE(manager.remove(vm::GuestAddress{0x1000}));
+    REQUIRE(manager.epoch() == 2);
+    REQUIRE(manager.view()->empty());
+
+    // The old generation still translates: the region stays mapped until
+    // the last view referencing it is dropped.
+    old_view->write_obj(vm::GuestAddress{0x1234}, uint8_t{42});
+    REQUIRE(old_view->read_obj<uint8_t>(vm::GuestAddress{0x1234}) == 42);
+}
+
+TEST_CASE("Pinned translation handles") {
+    auto manager = vm::MemslotManager{};
+    const auto region = manager.insert(
+        vm::GuestMemoryRegion{vm::GuestAddress{0x1000}, 0x1000});
+
+    REQUIRE_THROWS(vm::PinnedRegion{manager, vm::GuestAddress{0x1000}, 0});
+
+    auto pinned = vm::PinnedRegion{manager, vm::GuestAddress{0x1800}, 0x100};
+
+    // The hot path returns the cached pointer as long as the generation
+    // stands still.
+    REQUIRE(pinned.get() ==
+            static_cast<unsigned char*>(region->data()) + 0x800);
+    REQUIRE(pinned.get() ==
+            static_cast<unsigned char*>(region->data()) + 0x800);
+
+    // A range that runs past the region never resolves.
+    auto straddling = vm::PinnedRegion{manager, vm::GuestAddress{0x1f00}, 0x200};
+    REQUIRE(straddling.get() == nullptr);
+
+    // A layout change invalidates the handle; re-inserting the slot makes
+    // the next get() resolve again.
+    REQUIRE(manager.remove(vm::GuestAddress{0x1000}));
+    REQUIRE(pinned.get() == nullptr);
+
+    manager.insert(vm::GuestMemoryRegion{vm::GuestAddress{0x1000}, 0x1000});
+    REQUIRE(pinned.get() != nullptr);
+    REQUIRE(pinned.addr().data() == 0x1800);
+    REQUIRE(pinned.size() == 0x100);
+}
+
+TEST_CASE("Translation while the layout changes") {
+    auto manager = vm::MemslotManager{};
+
+    manager.insert(vm::GuestMemoryRegion{vm::GuestAddress{0x1000}, 0x1000});
+
+    auto stop = std::atomic<bool>{false};
+
+    // A reader hammers translation with fresh views while the writer
+    // churns an unrelated slot; every lookup must land in a coherent
+    // table. (Catch assertions aren't thread-safe, so failures are only
+    // counted here and checked after the join.)
+    auto misses = std::atomic<int>{0};
+
+    auto reader = std::thread{[&] {
+        while (!stop.load(std::memory_order_relaxed)) {
+            const auto view = manager.view();
+
+            if (view->find_region(vm::GuestAddress{0x1800}) == nullptr)
+                misses.fetch_add(1, std::memory_order_relaxed);
+        }
+    }};
+
+    for (auto i = 0; i < 100; i++) {
+        manager.insert(vm::GuestMemoryRegion{vm::GuestAddress{0x10000}, 0x1000});
+        manager.remove(vm::GuestAddress{0x10000});
+    }
+
+    stop.store(true, std::memory_order_relaxed);
+    reader.join();
+
+    REQUIRE(misses.load() == 0);
+    REQUIRE(manager.epoch() == 201);
+}
@@ -0,0 +1,53 @@
+#define CATCH_CONFIG_MAIN
+
+#include <cstring>
+
+#include <catch2/catch.hpp>
+
+#include "vmm/memory/memory.hpp"
+
+namespace vm = vmm::memory;
+
+TEST_CASE("Copy-on-write fork") {
+    auto memory = vm::GuestMemory{};
+    memory.insert(vm::GuestMemoryRegion{vm::GuestAddress{0x1000}, 0x2000});
+    memory.insert(vm::GuestMemoryRegion{vm::GuestAddress{0x8000}, 0x1000});
+
+    std::memset(memory.get_host_address(vm::GuestAddress{0x1000}), 0xaa, 0x2000);
+    std::memset(memory.get_host_address(vm::GuestAddress{0x8000}), 0xbb, 0x1000);
+
+    const auto snapshot = vm::MemorySnapshot{memory};
+    REQUIRE(snapshot.size() == 0x3000);
+
+    auto first = snapshot.fork();
+    auto second = snapshot.fork();
+
+    // Children inherit the template's layout and contents.
+    REQUIRE(first.size() == 2);
+    REQUIRE(first.region(0).start().data() == 0x1000);
+    REQUIRE(first.region(1).start().data() == 0x8000);
+
+    auto* host = static_cast<unsigned char*>(
+        first.get_host_address(vm::GuestAddress{0x1234}));
+    REQUIRE(host != nullptr);
+    REQUIRE(*host == 0xaa);
+
+    // A child's writes are private: siblings and the template see nothing.
+    *host = 0x11;
+
+    const auto* sibling = static_cast<unsigned char*>(
+        second.get_host_address(vm::GuestAddress{0x1234}));
+    REQUIRE(*sibling == 0xaa);
+
+    const auto* original = static_cast<unsigned char*>(
+        memory.get_host_address(vm::GuestAddress{0x1234}));
+    REQUIRE(*original == 0xaa);
+
+    // Later template writes do not leak into existing children either; the
+    // snapshot was frozen at construction.
+    std::memset(memory.get_host_address(vm::GuestAddress{0x8000}), 0xcc, 0x1000);
+
+    const auto* child = static_cast<unsigned char*>(
+        first.get_host_address(vm::GuestAddress{0x8000}));
+    REQUIRE(*child == 0xbb);
+}
@@ -42,3 +42,14 @@ TEST_CASE("EventFd clone") {
     fd.write(234);
     REQUIRE(clone2.read() == 234);
 }
+
+TEST_CASE("EventFd non-throwing paths") {
+    auto fd = vt::EventFd{EFD_NONBLOCK};
+    auto value = uint64_t{};
+
+    REQUIRE(fd.try_read(value) == std::errc::resource_unavailable_try_again);
+
+    REQUIRE(!fd.try_write(42));
+    REQUIRE(!fd.try_read(value));
+    REQUIRE(value == 42);
+}
@@ -0,0 +1,56 @@
+#define CATCH_CONFIG_MAIN
+
+#include <catch2/catch.hpp>
+
+#include "vmm/types/event_loop.hpp"
+
+namespace vt = vmm::types;
+
+TEST_CASE("EventLoop creation") {
+    REQUIRE_NOTHROW(vt::EventLoop{});
+}
+
+TEST_CASE("EventLoop dispatch") {
+    auto loop = vt::EventLoop{};
+    auto first = vt::EventFd{EFD_NONBLOCK};
+    auto second = vt::EventFd{EFD_NONBLOCK};
+
+    auto counts = std::vector<uint64_t>{};
+
+    loop.add(first, [&](vt::EventFd&, uint64_t value) {
+        counts.push_back(value);
+    });
+    loop.add(second, [&](vt::EventFd&, uint64_t value) {
+        counts.push_back(value * 100);
+    });
+    REQUIRE(loop.size() == 2);
+
+    // Nothing signaled yet.
+    REQUIRE(loop.dispatch(0) == 0);
+
+    // Multiple signals on one fd coalesce into a single callback.
+    first.write(1);
+    first.write(1);
+    second.write(3);
+
+    REQUIRE(loop.dispatch(0) == 2);
+    REQUIRE(counts.size() == 2);
+    REQUIRE((counts[0] + counts[1]) == 302);
+
+    // Counters were drained by the dispatch.
+    REQUIRE(loop.dispatch(0) == 0);
+}
+
+TEST_CASE("EventLoop remove") {
+    auto loop = vt::EventLoop{};
+    auto fd = vt::EventFd{EFD_NONBLOCK};
+    auto fired = false;
+
+    loop.add(fd, [&](vt::EventFd&, uint64_t) { fired = true; });
+    loop.remove(fd);
+    REQUIRE(loop.size() == 0);
+
+    fd.write(1);
+    REQUIRE(loop.dispatch(0) == 0);
+    REQUIRE(!fired);
+}
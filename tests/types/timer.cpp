@@ -0,0 +1,83 @@
+#define CATCH_CONFIG_MAIN
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "vmm/types/timer.hpp"
+
+using namespace std::chrono_literals;
+
+TEST_CASE("Timer fd") {
+    auto timer = vmm::types::TimerFd{};
+
+    timer.arm(1ms);
+    REQUIRE(timer.read() >= 1);
+
+    // A periodic timer accumulates expirations between reads.
+    timer.arm_periodic(1ms);
+    std::this_thread::sleep_for(5ms);
+    REQUIRE(timer.read() >= 2);
+
+    timer.disarm();
+}
+
+TEST_CASE("Nonblocking timer fd") {
+    auto timer = vmm::types::TimerFd{TFD_NONBLOCK};
+    auto expirations = uint64_t{};
+
+    // Nothing armed: the read would block, so it reports EAGAIN.
+    REQUIRE(timer.try_read(expirations) ==
+            std::errc::resource_unavailable_try_again);
+
+    timer.arm(1ms);
+    std::this_thread::sleep_for(5ms);
+    REQUIRE_FALSE(timer.try_read(expirations));
+    REQUIRE(expirations == 1);
+}
+
+TEST_CASE("Timer wheel") {
+    auto wheel = vmm::types::TimerWheel{1ms, 16};
+    auto fired = 0;
+
+    wheel.arm(2ms, [&fired] { fired += 1; });
+    wheel.arm(2ms, [&fired] { fired += 10; });
+    const auto late = wheel.arm(1h, [&fired] { fired += 100; });
+
+    REQUIRE(wheel.size() == 3);
+
+    // Both near deadlines fire in one batch; the distant one stays.
+    std::this_thread::sleep_for(5ms);
+    REQUIRE(wheel.expire() == 2);
+    REQUIRE(fired == 11);
+    REQUIRE(wheel.size() == 1);
+
+    // Cancellation is final: the wheel empties without firing.
+    wheel.cancel(late);
+    wheel.cancel(late);
+    REQUIRE(wheel.size() == 0);
+    REQUIRE(wheel.expire() == 0);
+    REQUIRE(fired == 11);
+}
+
+TEST_CASE("Timer wheel rearms for the next deadline") {
+    auto wheel = vmm::types::TimerWheel{1ms, 16};
+    auto order = std::vector<int>{};
+
+    wheel.arm(1ms, [&order] { order.push_back(1); });
+
+    // Deadlines past one revolution (16ms) alias onto near slots and must
+    // still fire no earlier than requested.
+    wheel.arm(30ms, [&order] { order.push_back(2); });
+
+    const auto deadline = std::chrono::steady_clock::now() + 200ms;
+
+    while (wheel.size() > 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(1ms);
+        wheel.expire();
+    }
+
+    REQUIRE(order == std::vector<int>{1, 2});
+}
@@ -3,3 +3,33 @@
 #include <catch2/catch.hpp>
 
 #include "vmm/virtio/virtio.hpp"
+
+namespace {
+
+class StubDevice : public vmm::virtio::VirtDevice
+{
+    public:
+        StubDevice() : VirtDevice{2, vmm::virtio::VIRTIO_F_VERSION_1 |
+                                     vmm::virtio::VIRTIO_F_EVENT_IDX} {}
+};
+
+}  // namespace
+
+TEST_CASE("Feature negotiation") {
+    auto device = StubDevice{};
+
+    REQUIRE(device.device_type() == 2);
+    REQUIRE(device.features() ==
+            (vmm::virtio::VIRTIO_F_VERSION_1 | vmm::virtio::VIRTIO_F_EVENT_IDX));
+    REQUIRE(device.driver_features() == 0);
+    REQUIRE(!device.event_idx());
+
+    // The driver may ack any subset of what was offered, nothing more.
+    REQUIRE_THROWS_AS(device.ack_features(vmm::virtio::VIRTIO_F_RING_PACKED),
+                      std::invalid_argument);
+
+    device.ack_features(vmm::virtio::VIRTIO_F_VERSION_1 |
+                        vmm::virtio::VIRTIO_F_EVENT_IDX);
+    REQUIRE(device.event_idx());
+    REQUIRE(device.num_queues() == 0);
+}
@@ -0,0 +1,97 @@
+#define CATCH_CONFIG_MAIN
+
+#include <catch2/catch.hpp>
+
+#include "vmm/memory/guest.hpp"
+#include "vmm/virtio/virtio.hpp"
+
+namespace vm = vmm::memory;
+namespace vq = vmm::virtio;
+
+namespace {
+
+constexpr uint16_t VIRTQ_DESC_F_NEXT = 1;
+constexpr uint16_t VIRTQ_DESC_F_WRITE = 2;
+
+}  // namespace
+
+TEST_CASE("Chain to iovec translation") {
+    auto memory = vm::GuestMemory{};
+    memory.insert(vm::GuestMemoryRegion{vm::GuestAddress{0x1000}, 0x1000});
+    memory.insert(vm::GuestMemoryRegion{vm::GuestAddress{0x2000}, 0x1000});
+
+    // One readable descriptor followed by one writable descriptor.
+    vq::VirtqDesc table[4] = {};
+    table[0] = {0x1000, 0x100, VIRTQ_DESC_F_NEXT, 1};
+    table[1] = {0x2000, 0x200, VIRTQ_DESC_F_WRITE, 0};
+
+    const auto chain = vq::DescriptorChain{table, 4, 0, nullptr};
+
+    iovec iov[4];
+    const auto result = vq::chain_to_iovecs(chain, memory, iov, 4);
+
+    REQUIRE(result.ok);
+    REQUIRE(result.count == 2);
+    REQUIRE(result.readable == 1);
+    REQUIRE(iov[0].iov_base == memory.get_host_address(vm::GuestAddress{0x1000}));
+    REQUIRE(iov[0].iov_len == 0x100);
+    REQUIRE(iov[1].iov_base == memory.get_host_address(vm::GuestAddress{0x2000}));
+    REQUIRE(iov[1].iov_len == 0x200);
+}
+
+TEST_CASE("Chain split across region boundaries") {
+    auto memory = vm::GuestMemory{};
+    memory.insert(vm::GuestMemoryRegion{vm::GuestAddress{0x1000}, 0x1000});
+    memory.insert(vm::GuestMemoryRegion{vm::GuestAddress{0x2000}, 0x1000});
+
+    // A single buffer straddling two adjacent regions becomes two iovecs;
+    // the regions are not host-contiguous.
+    vq::VirtqDesc table[1] = {};
+    table[0] = {0x1f00, 0x200, 0, 0};
+
+    const auto chain = vq::DescriptorChain{table, 1, 0, nullptr};
+
+    iovec iov[4];
+    const auto result = vq::chain_to_iovecs(chain, memory, iov, 4);
+
+    REQUIRE(result.ok);
+    REQUIRE(result.count == 2);
+    REQUIRE(result.readable == 2);
+    REQUIRE(iov[0].iov_base == memory.get_host_address(vm::GuestAddress{0x1f00}));
+    REQUIRE(iov[0].iov_len == 0x100);
+    REQUIRE(iov[1].iov_base == memory.get_host_address(vm::GuestAddress{0x2000}));
+    REQUIRE(iov[1].iov_len == 0x100);
+}
+
+TEST_CASE("Malformed chains fail translation") {
+    auto memory = vm::GuestMemory{};
+    memory.insert(vm::GuestMemoryRegion{vm::GuestAddress{0x1000}, 0x1000});
+
+    iovec iov[4];
+
+    SECTION("unmapped guest memory") {
+        vq::VirtqDesc table[1] = {};
+        table[0] = {0x9000, 0x100, 0, 0};
+
+        const auto chain = vq::DescriptorChain{table, 1, 0, nullptr};
+        REQUIRE(!vq::chain_to_iovecs(chain, memory, iov, 4).ok);
+    }
+
+    SECTION("readable descriptor after a writable one") {
+        vq::VirtqDesc table[2] = {};
+        table[0] = {0x1000, 0x100, VIRTQ_DESC_F_NEXT | VIRTQ_DESC_F_WRITE, 1};
+        table[1] = {0x1100, 0x100, 0, 0};
+
+        const auto chain = vq::DescriptorChain{table, 2, 0, nullptr};
+        REQUIRE(!vq::chain_to_iovecs(chain, memory, iov, 4).ok);
+    }
+
+    SECTION("array too small") {
+        vq::VirtqDesc table[2] = {};
+        table[0] = {0x1000, 0x100, VIRTQ_DESC_F_NEXT, 1};
+        table[1] = {0x1100, 0x100, 0, 0};
+
+        const auto chain = vq::DescriptorChain{table, 2, 0, nullptr};
+        REQUIRE(!vq::chain_to_iovecs(chain, memory, iov, 1).ok);
+    }
+}
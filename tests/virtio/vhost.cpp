@@ -0,0 +1,26 @@
+#define CATCH_CONFIG_MAIN
+
+#include <unistd.h> // access
+
+#include <catch2/catch.hpp>
+
+#include "vmm/memory/memory.hpp"
+#include "vmm/virtio/virtio.hpp"
+
+TEST_CASE("Vhost-net device") {
+    // Hosts without the vhost_net module (or with a restricted CI sandbox)
+    // have nothing to drive; that is not a failure.
+    if (access("/dev/vhost-net", R_OK | W_OK) != 0)
+        return;
+
+    auto net = vmm::virtio::VhostNet{};
+
+    // Every vhost backend offers at least the base ring features.
+    REQUIRE(net.features() != 0);
+
+    auto memory = vmm::memory::GuestMemory{};
+    memory.insert(vmm::memory::GuestMemoryRegion{
+        vmm::memory::GuestAddress{0x1000}, 0x10000});
+
+    REQUIRE_NOTHROW(net.set_mem_table(memory));
+}
@@ -0,0 +1,125 @@
+//
+// bus.cpp - MMIO/PIO device bus
+//
+
+#include <algorithm> // upper_bound
+#include <atomic> // atomic_load_explicit, atomic_store_explicit
+#include <stdexcept> // invalid_argument, out_of_range
+#include <utility> // move
+
+#include "vmm/devices/detail/bus.hpp"
+#include "vmm/types/detail/exceptions.hpp"
+
+namespace vmm::devices::detail {
+
+auto Bus::find(const Snapshot& entries, uint64_t address) noexcept
+    -> const Entry*
+{
+    // The first range with base > address; only its predecessor can
+    // contain the address.
+    const auto next = std::upper_bound(entries.begin(), entries.end(),
+                                       address,
+                                       [](uint64_t lhs, const Entry& rhs) {
+                                           return lhs < rhs.base;
+                                       });
+
+    if (next == entries.begin())
+        return nullptr;
+
+    const auto& entry = *std::prev(next);
+
+    if (address - entry.base >= entry.size)
+        return nullptr;
+
+    return &entry;
+}
+
+auto Bus::add(uint64_t base, uint64_t size,
+              std::shared_ptr<BusDevice> device) -> void
+{
+    if (size == 0 || base + size < base)
+        VMM_THROW(std::invalid_argument("Invalid bus range"));
+
+    const auto lock = std::lock_guard<std::mutex>{m_mutex};
+    auto entries = Snapshot{*std::atomic_load_explicit(
+            &m_entries, std::memory_order_relaxed)};
+
+    const auto pos = std::upper_bound(entries.begin(), entries.end(), base,
+                                      [](uint64_t lhs, const Entry& rhs) {
+                                          return lhs < rhs.base;
+                                      });
+
+    if (pos != entries.begin() &&
+        base - std::prev(pos)->base < std::prev(pos)->size)
+        VMM_THROW(std::invalid_argument("Overlapping bus range"));
+
+    if (pos != entries.end() && pos->base - base < size)
+        VMM_THROW(std::invalid_argument("Overlapping bus range"));
+
+    entries.insert(pos, Entry{base, size, std::move(device)});
+
+    std::atomic_store_explicit(
+            &m_entries,
+            std::shared_ptr<const Snapshot>{
+                std::make_shared<Snapshot>(std::move(entries))},
+            std::memory_order_release);
+}
+
+auto Bus::remove(uint64_t base) -> void
+{
+    const auto lock = std::lock_guard<std::mutex>{m_mutex};
+    auto entries = Snapshot{*std::atomic_load_explicit(
+            &m_entries, std::memory_order_relaxed)};
+
+    const auto pos = std::find_if(entries.begin(), entries.end(),
+                                  [base](const Entry& entry) {
+                                      return entry.base == base;
+                                  });
+
+    if (pos == entries.end())
+        VMM_THROW(std::out_of_range("No bus range at address"));
+
+    entries.erase(pos);
+
+    std::atomic_store_explicit(
+            &m_entries,
+            std::shared_ptr<const Snapshot>{
+                std::make_shared<Snapshot>(std::move(entries))},
+            std::memory_order_release);
+}
+
+auto Bus::read(uint64_t address, uint8_t *data, uint32_t size) const -> bool
+{
+    const auto entries = std::atomic_load_explicit(&m_entries,
+                                                   std::memory_order_acquire);
+    const auto* entry = find(*entries, address);
+
+    if (!entry)
+        return false;
+
+    entry->device->read(address - entry->base, data, size);
+    return true;
+}
+
+auto Bus::write(uint64_t address, const uint8_t *data,
+                uint32_t size) const -> bool
+{
+    const auto entries = std::atomic_load_explicit(&m_entries,
+                                                   std::memory_order_acquire);
+    const auto* entry = find(*entries, address);
+
+    if (!entry)
+        return false;
+
+    entry->device->write(address - entry->base, data, size);
+    return true;
+}
+
+auto Bus::size() const noexcept -> std::size_t
+{
+    const auto entries = std::atomic_load_explicit(&m_entries,
+                                                   std::memory_order_acquire);
+    return entries->size();
+}
+
+}  // namespace vmm::devices::detail
@@ -0,0 +1,14 @@
+//
+// devices.hpp - Public device header
+//
+
+#pragma once
+
+#include "vmm/devices/detail/bus.hpp"
+
+namespace vmm::devices {
+
+using Bus = vmm::devices::detail::Bus;
+using BusDevice = vmm::devices::detail::BusDevice;
+
+}  // namespace vmm::devices
@@ -0,0 +1,261 @@
+//
+// engine.cpp - io_uring-backed asynchronous I/O engine
+//
+
+#include <utility> // exchange
+
+#include <sys/mman.h> // mmap, munmap
+#include <sys/syscall.h> // __NR_io_uring_*
+#include <unistd.h> // syscall
+
+#include "vmm/io/detail/engine.hpp"
+
+namespace vmm::io::detail {
+
+namespace {
+
+// No glibc wrappers exist for the io_uring syscalls.
+auto io_uring_setup(uint32_t entries, io_uring_params* params) -> int
+{
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+auto io_uring_enter(int fd, uint32_t to_submit, uint32_t min_complete,
+                    uint32_t flags) -> int
+{
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit,
+                                      min_complete, flags, nullptr, 0));
+}
+
+auto io_uring_register(int fd, uint32_t opcode, const void* arg,
+                       uint32_t nr_args) -> int
+{
+    return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode,
+                                      arg, nr_args));
+}
+
+auto ring_mmap(int fd, std::size_t size, uint64_t offset) -> void*
+{
+    auto* ptr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, fd,
+                       static_cast<off_t>(offset));
+
+    if (ptr == MAP_FAILED)
+        VMM_THROW(std::system_error(errno, std::system_category()));
+
+    return ptr;
+}
+
+}  // namespace
+
+IoEngine::IoEngine(uint32_t entries)
+{
+    auto params = io_uring_params{};
+
+    m_fd = io_uring_setup(entries, &params);
+
+    if (m_fd < 0)
+        VMM_THROW(std::system_error(errno, std::system_category()));
+
+    m_sq_ring_size = params.sq_off.array +
+                     params.sq_entries * sizeof(uint32_t);
+    m_cq_ring_size = params.cq_off.cqes +
+                     params.cq_entries * sizeof(io_uring_cqe);
+
+    // Newer kernels expose both rings through one mapping.
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (m_cq_ring_size > m_sq_ring_size)
+            m_sq_ring_size = m_cq_ring_size;
+
+        m_sq_ring = ring_mmap(m_fd, m_sq_ring_size, IORING_OFF_SQ_RING);
+        m_cq_ring = m_sq_ring;
+        m_cq_ring_size = 0;
+    }
+    else {
+        m_sq_ring = ring_mmap(m_fd, m_sq_ring_size, IORING_OFF_SQ_RING);
+        m_cq_ring = ring_mmap(m_fd, m_cq_ring_size, IORING_OFF_CQ_RING);
+    }
+
+    m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    m_sqes = static_cast<io_uring_sqe*>(
+        ring_mmap(m_fd, m_sqes_size, IORING_OFF_SQES));
+
+    auto* sq = static_cast<char*>(m_sq_ring);
+    m_sq_head = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+    m_sq_tail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+    m_sq_mask = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+    m_sq_entries = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_entries);
+    m_sq_array = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+    m_sq_tail_cached = *m_sq_tail;
+
+    auto* cq = static_cast<char*>(m_cq_ring);
+    m_cq_head = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+    m_cq_tail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+    m_cq_mask = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+    m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+}
+
+IoEngine::~IoEngine() noexcept
+{
+    if (m_sqes)
+        ::munmap(m_sqes, m_sqes_size);
+
+    if (m_cq_ring && m_cq_ring != m_sq_ring)
+        ::munmap(m_cq_ring, m_cq_ring_size);
+
+    if (m_sq_ring)
+        ::munmap(m_sq_ring, m_sq_ring_size);
+}
+
+IoEngine::IoEngine(IoEngine&& other) noexcept
+    : FileDescriptor{std::move(other)},
+      m_sq_ring{std::exchange(other.m_sq_ring, nullptr)},
+      m_sq_ring_size{other.m_sq_ring_size},
+      m_cq_ring{std::exchange(other.m_cq_ring, nullptr)},
+      m_cq_ring_size{other.m_cq_ring_size},
+      m_sqes{std::exchange(other.m_sqes, nullptr)},
+      m_sqes_size{other.m_sqes_size},
+      m_sq_head{other.m_sq_head},
+      m_sq_tail{other.m_sq_tail},
+      m_sq_mask{other.m_sq_mask},
+      m_sq_entries{other.m_sq_entries},
+      m_sq_array{other.m_sq_array},
+      m_sq_tail_cached{other.m_sq_tail_cached},
+      m_cq_head{other.m_cq_head},
+      m_cq_tail{other.m_cq_tail},
+      m_cq_mask{other.m_cq_mask},
+      m_cqes{other.m_cqes},
+      m_pending{other.m_pending}
+{
+}
+
+auto IoEngine::register_buffers(const std::vector<iovec>& buffers) -> void
+{
+    if (io_uring_register(m_fd, IORING_REGISTER_BUFFERS, buffers.data(),
+                          static_cast<uint32_t>(buffers.size())) < 0)
+        VMM_THROW(std::system_error(errno, std::system_category()));
+}
+
+auto IoEngine::register_buffers(const vmm::memory::detail::GuestMemory& memory) -> void
+{
+    auto buffers = std::vector<iovec>{};
+    buffers.reserve(memory.size());
+
+    for (auto i = std::size_t{}; i < memory.size(); i++) {
+        const auto& region = memory.region(i);
+        buffers.push_back(iovec{region.data(), region.size()});
+    }
+
+    register_buffers(buffers);
+}
+
+auto IoEngine::unregister_buffers() -> void
+{
+    if (io_uring_register(m_fd, IORING_UNREGISTER_BUFFERS, nullptr, 0) < 0)
+        VMM_THROW(std::system_error(errno, std::system_category()));
+}
+
+auto IoEngine::register_eventfd(const vmm::types::EventFd& eventfd) -> void
+{
+    const auto fd = eventfd.fd();
+
+    if (io_uring_register(m_fd, IORING_REGISTER_EVENTFD, &fd, 1) < 0)
+        VMM_THROW(std::system_error(errno, std::system_category()));
+}
+
+auto IoEngine::unregister_eventfd() -> void
+{
+    if (io_uring_register(m_fd, IORING_UNREGISTER_EVENTFD, nullptr, 0) < 0)
+        VMM_THROW(std::system_error(errno, std::system_category()));
+}
+
+auto IoEngine::next_sqe() -> io_uring_sqe*
+{
+    const auto head = __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE);
+
+    if (m_sq_tail_cached - head >= m_sq_entries)
+        return nullptr;
+
+    const auto index = m_sq_tail_cached & m_sq_mask;
+
+    m_sq_array[index] = index;
+    m_sq_tail_cached++;
+    m_pending++;
+
+    auto* sqe = &m_sqes[index];
+    *sqe = io_uring_sqe{};
+
+    return sqe;
+}
+
+auto IoEngine::queue_rw(uint8_t opcode, int fd, uint64_t addr, uint32_t len,
+                        uint64_t offset, uint16_t buf_index,
+                        uint64_t user_data) -> bool
+{
+    auto* sqe = next_sqe();
+
+    if (sqe == nullptr)
+        return false;
+
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->addr = addr;
+    sqe->len = len;
+    sqe->off = offset;
+    sqe->buf_index = buf_index;
+    sqe->user_data = user_data;
+
+    return true;
+}
+
+auto IoEngine::queue_read(int fd, void* buf, uint32_t len, uint64_t offset,
+                          uint64_t user_data) -> bool
+{
+    return queue_rw(IORING_OP_READ, fd, reinterpret_cast<uintptr_t>(buf),
+                    len, offset, 0, user_data);
+}
+
+auto IoEngine::queue_write(int fd, const void* buf, uint32_t len,
+                           uint64_t offset, uint64_t user_data) -> bool
+{
+    return queue_rw(IORING_OP_WRITE, fd, reinterpret_cast<uintptr_t>(buf),
+                    len, offset, 0, user_data);
+}
+
+auto IoEngine::queue_read_fixed(int fd, void* buf, uint32_t len,
+                                uint64_t offset, uint16_t buf_index,
+                                uint64_t user_data) -> bool
+{
+    return queue_rw(IORING_OP_READ_FIXED, fd,
+                    reinterpret_cast<uintptr_t>(buf), len, offset, buf_index,
+                    user_data);
+}
+
+auto IoEngine::queue_write_fixed(int fd, const void* buf, uint32_t len,
+                                 uint64_t offset, uint16_t buf_index,
+                                 uint64_t user_data) -> bool
+{
+    return queue_rw(IORING_OP_WRITE_FIXED, fd,
+                    reinterpret_cast<uintptr_t>(buf), len, offset, buf_index,
+                    user_data);
+}
+
+auto IoEngine::submit() -> std::size_t
+{
+    if (m_pending == 0)
+        return 0;
+
+    __atomic_store_n(m_sq_tail, m_sq_tail_cached, __ATOMIC_RELEASE);
+
+    const auto ret = io_uring_enter(m_fd,
+                                    static_cast<uint32_t>(m_pending), 0, 0);
+
+    if (ret < 0)
+        VMM_THROW(std::system_error(errno, std::system_category()));
+
+    m_pending -= static_cast<std::size_t>(ret);
+
+    return static_cast<std::size_t>(ret);
+}
+
+}  // namespace vmm::io::detail
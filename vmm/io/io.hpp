@@ -0,0 +1,14 @@
+//
+// io.hpp - Public I/O header
+//
+
+#pragma once
+
+#include "vmm/io/detail/engine.hpp"
+
+namespace vmm::io {
+
+using IoEngine = vmm::io::detail::IoEngine;
+using Completion = vmm::io::detail::Completion;
+
+}  // namespace vmm::io
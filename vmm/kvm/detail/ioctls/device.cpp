@@ -8,17 +8,30 @@ namespace vmm::kvm::detail {
 
 auto Device::has_attr(kvm_device_attr &attr) -> bool
 {
+    // Deliberately uncached: ioctl() throws on an unsupported attribute
+    // (-ENXIO), so a negative probe never reaches a cache insert here.
+    // `supports_attr()` is the caching, non-throwing variant.
     return m_fd.ioctl(KVM_HAS_DEVICE_ATTR, &attr) == 0;
 }
 
-auto Device::get_attr(kvm_device_attr &attr) -> void
+auto Device::supports_attr(uint32_t group, uint64_t attr) -> bool
 {
-    m_fd.ioctl(KVM_GET_DEVICE_ATTR, &attr);
-}
+    const auto key = std::make_pair(group, attr);
+    const auto cached = m_attrs.find(key);
 
-auto Device::set_attr(kvm_device_attr &attr) -> void
-{
-    m_fd.ioctl(KVM_SET_DEVICE_ATTR, &attr);
+    if (cached != m_attrs.end())
+        return cached->second;
+
+    auto probe = kvm_device_attr{};
+    probe.group = group;
+    probe.attr = attr;
+
+    const auto supported = static_cast<bool>(
+        m_fd.try_ioctl(KVM_HAS_DEVICE_ATTR, &probe));
+
+    m_attrs.insert_or_assign(key, supported);
+
+    return supported;
 }
 
 }  // namespace vmm::kvm::detail
@@ -4,7 +4,12 @@
 
 #pragma once
 
-#include <cstdint> // uint32_t
+#include <cstddef> // size_t
+#include <cstdint> // uint32_t, uint64_t
+#include <map> // map
+#include <system_error> // error_code
+#include <utility> // pair
+#include <vector> // vector
 #include <linux/kvm.h> // kvm_*, KVM_*
 
 #include "vmm/kvm/detail/ioctls/vm.hpp"
@@ -12,6 +17,14 @@
 
 namespace vmm::kvm::detail {
 
+// One failed entry from a batched attribute submission; `index` is the
+// entry's position in the submitted container.
+struct DeviceAttrError
+{
+    std::size_t index;
+    std::error_code error;
+};
+
 class Device
 {
     private:
@@ -19,6 +32,11 @@ class Device
         uint32_t m_type;
         uint32_t m_flags;
 
+        // KVM_HAS_DEVICE_ATTR probe results, keyed by (group, attr). A
+        // device never gains or loses attributes after creation, so a probe
+        // answer is valid for the device's lifetime.
+        std::map<std::pair<uint32_t, uint64_t>, bool> m_attrs{};
+
         friend Device Vm::device(uint32_t type, uint32_t flags) const;
 
         Device(const kvm_create_device& dev) noexcept
@@ -30,15 +48,68 @@ class Device
         // See the documentation for KVM_HAS_DEVICE_ATTR.
         auto has_attr(kvm_device_attr&) -> bool;
 
+        // Non-throwing counterpart of `has_attr()` with caching: the kernel
+        // is probed once per (group, attr) and the answer is remembered, so
+        // capability checks after the first cost a map lookup instead of an
+        // ioctl. Configuring a vGIC/ITS re-probes the same handful of groups
+        // constantly; this keeps those probes off the boot path.
+        [[nodiscard]] auto supports_attr(uint32_t group, uint64_t attr) -> bool;
+
         // Gets a specified piece of device configuration/state.
         //
         // See the documentation for KVM_GET_DEVICE_ATTR.
-        auto get_attr(kvm_device_attr&) -> void;
+        auto get_attr(kvm_device_attr& attr) -> void
+        {
+            m_fd.ioctl(KVM_GET_DEVICE_ATTR, &attr);
+        }
 
         // Sets a specified piece of device configuration/state.
         //
         // See the documentation for KVM_SET_DEVICE_ATTR.
-        auto set_attr(kvm_device_attr&) -> void;
+        auto set_attr(kvm_device_attr& attr) -> void
+        {
+            m_fd.ioctl(KVM_SET_DEVICE_ATTR, &attr);
+        }
+
+        // Gets every attribute in `attrs` in one pass. A failed entry is
+        // recorded and the loop moves on, so one bad attribute doesn't
+        // abandon the rest of the batch; the result is empty when every
+        // entry succeeded.
+        template<typename T,
+                 typename=std::enable_if_t<std::is_same_v<typename T::value_type,
+                                                          kvm_device_attr>>>
+        auto get_attrs(T& attrs) -> std::vector<DeviceAttrError>
+        {
+            return batch_attrs(KVM_GET_DEVICE_ATTR, attrs);
+        }
+
+        // Sets every attribute in `attrs` in one pass, aggregating failures
+        // like `get_attrs()`. Device setup (vGIC redistributors, ITS
+        // tables) issues hundreds of these at boot; batching keeps the
+        // error handling out of the per-attribute loop.
+        template<typename T,
+                 typename=std::enable_if_t<std::is_same_v<typename T::value_type,
+                                                          kvm_device_attr>>>
+        auto set_attrs(T& attrs) -> std::vector<DeviceAttrError>
+        {
+            return batch_attrs(KVM_SET_DEVICE_ATTR, attrs);
+        }
+    private:
+        template<typename T>
+        auto batch_attrs(long unsigned req, T& attrs) -> std::vector<DeviceAttrError>
+        {
+            auto errors = std::vector<DeviceAttrError>{};
+            auto index = std::size_t{};
+
+            for (auto& attr : attrs) {
+                if (const auto ret = m_fd.try_ioctl(req, &attr); !ret)
+                    errors.push_back({index, ret.error()});
+
+                index++;
+            }
+
+            return errors;
+        }
 };
 
 }  // namespace vmm::kvm::detail
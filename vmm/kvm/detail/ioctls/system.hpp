@@ -4,7 +4,10 @@
 
 #pragma once
 
-#include <cstddef> // size_t
+#include <atomic> // atomic_compare_exchange_strong_explicit, atomic_load_explicit
+#include <cstddef> // byte, size_t
+#include <memory> // make_shared, shared_ptr
+#include <memory_resource> // new_delete_resource, polymorphic_allocator
 #include <system_error> // error_code, system_category, system_error
 #include <type_traits> // enable_if_t, is_same_v
 #include <fcntl.h> // open
@@ -60,7 +63,10 @@ class System
         // Returns the kvm API version.
         //
         // See the documentation for KVM_GET_API_VERSION.
-        [[nodiscard]] auto api_version() const -> int;
+        [[nodiscard]] auto api_version() const -> int
+        {
+            return m_fd.ioctl(KVM_GET_API_VERSION);
+        }
 
         // Creates and returns a virtual machine (with a custom machine type).
         //
@@ -75,11 +81,17 @@ class System
         // Based on their initialization, VMs may have different capabilities.
         // Therefore, `kvm::Vm::check_extension()` is preferred when querying
         // for most capabilities.
-        [[nodiscard]] auto check_extension(int cap) const -> int;
+        [[nodiscard]] auto check_extension(int cap) const -> int
+        {
+            return m_fd.ioctl(KVM_CHECK_EXTENSION, cap);
+        }
 
         // Returns the size of the memory region used by the KVM_RUN ioctl to
         // communicate CPU information to userspace.
-        [[nodiscard]] auto vcpu_mmap_size() const -> std::size_t;
+        [[nodiscard]] auto vcpu_mmap_size() const -> std::size_t
+        {
+            return static_cast<std::size_t>(m_fd.ioctl(KVM_GET_VCPU_MMAP_SIZE));
+        }
 
 #if defined(__i386__) || defined(__x86_64__)
         // TODO: Allocator variants for FAM struct methods
@@ -139,11 +151,85 @@ class System
             m_fd.ioctl(KVM_GET_EMULATED_CPUID, cpuids.data());
             return cpuids;
         }
+
+        // An immutable snapshot of the host's feature lists. Host
+        // capabilities cannot change while /dev/kvm is open, so one query
+        // serves every vcpu configured afterwards.
+        struct FeatureSnapshot
+        {
+            Cpuids<MAX_CPUID_ENTRIES> supported_cpuids;
+            Cpuids<MAX_CPUID_ENTRIES> emulated_cpuids;
+            MsrList<MAX_IO_MSRS> msr_indices;
+            MsrList<MAX_IO_MSRS_FEATURES> msr_features;
+        };
+
+        // Returns the cached feature snapshot, querying KVM only on the
+        // first call. Safe to call concurrently (e.g. from `Vm::vcpus()`
+        // workers); losers of the one-time build race adopt the winner's
+        // snapshot. The reference stays valid for the System's lifetime.
+        [[nodiscard]] auto features() const -> const FeatureSnapshot&
+        {
+            auto snapshot = std::atomic_load_explicit(
+                &m_features, std::memory_order_acquire);
+
+            if (!snapshot) {
+                // The FAM structs must not use the default fam_resource():
+                // that pool is thread-local, and a snapshot built on a
+                // short-lived thread (a Vm::vcpus() worker, say) would
+                // dangle once that thread exits. The snapshot lives as long
+                // as the System, so its members go on the process-lifetime
+                // heap.
+                const auto alloc = std::pmr::polymorphic_allocator<std::byte>{
+                    std::pmr::new_delete_resource()};
+
+                auto building = std::make_shared<FeatureSnapshot>(
+                    FeatureSnapshot{Cpuids<MAX_CPUID_ENTRIES>{alloc},
+                                    Cpuids<MAX_CPUID_ENTRIES>{alloc},
+                                    MsrList<MAX_IO_MSRS>{alloc},
+                                    MsrList<MAX_IO_MSRS_FEATURES>{alloc}});
+
+                m_fd.ioctl(KVM_GET_SUPPORTED_CPUID,
+                           building->supported_cpuids.data());
+                m_fd.ioctl(KVM_GET_EMULATED_CPUID,
+                           building->emulated_cpuids.data());
+                m_fd.ioctl(KVM_GET_MSR_INDEX_LIST,
+                           building->msr_indices.data());
+                m_fd.ioctl(KVM_GET_MSR_FEATURE_INDEX_LIST,
+                           building->msr_features.data());
+
+                auto built = std::shared_ptr<const FeatureSnapshot>{
+                    std::move(building)};
+
+                if (std::atomic_compare_exchange_strong_explicit(
+                        &m_features, &snapshot, built,
+                        std::memory_order_acq_rel, std::memory_order_acquire))
+                    snapshot = std::move(built);
+            }
+
+            return *snapshot;
+        }
+
+        // Stamps out a per-vcpu cpuid table from the cached snapshot: one
+        // FAM copy, no ioctl. The copy is the usual starting point for
+        // per-vcpu filtering before KVM_SET_CPUID2.
+        [[nodiscard]] auto vcpu_cpuids() const -> Cpuids<MAX_CPUID_ENTRIES>
+        {
+            return features().supported_cpuids;
+        }
 #endif
 
 #if defined(__arm__)  || defined(__aarch64__)
         // Returns the IPA size for a VM; 0 if the capability isn't available.
-        [[nodiscard]] auto host_ipa_limit() const -> std::size_t;
+        [[nodiscard]] auto host_ipa_limit() const -> std::size_t
+        {
+            return static_cast<std::size_t>(m_fd.ioctl(KVM_CAP_ARM_VM_IPA_SIZE));
+        }
+#endif
+
+#if defined(__i386__) || defined(__x86_64__)
+    private:
+        // Built on first use by `features()`; never replaced afterwards.
+        mutable std::shared_ptr<const FeatureSnapshot> m_features{};
 #endif
 };
 
@@ -4,12 +4,75 @@
 
 #include <stdexcept> // runtime_error
 
+#if defined(__i386__) || defined(__x86_64__)
+#include <cstring> // memcpy
+#include <exception> // exception_ptr, current_exception, rethrow_exception
+#include <mutex> // mutex, lock_guard
+#include <thread> // thread
+#include <vector> // vector
+#endif
+
+#if defined(VMM_VCPU_STATS)
+#include <chrono> // steady_clock, duration_cast, nanoseconds
+#endif
+
+#include <pthread.h> // pthread_self, pthread_kill
+#include <signal.h> // sigaction, sigemptyset
 #include <sys/mman.h> // mmap, PROT_READ, PROT_WRITE, MAP_FAILED, MAP_SHARED
+#include <unistd.h> // sysconf, _SC_PAGESIZE
 
 #include "vmm/kvm/detail/ioctls/vcpu.hpp"
 #include "vmm/types/detail/exceptions.hpp"
 
 namespace vmm::kvm::detail {
+    DirtyRing::DirtyRing(int vcpu_fd, uint32_t size)
+        : m_size{size}
+    {
+        const auto page_size = sysconf(_SC_PAGESIZE);
+
+        if (page_size <= 0)
+            VMM_THROW(std::system_error(errno, std::system_category()));
+
+        const auto offset = static_cast<off_t>(page_size) *
+                            KVM_DIRTY_LOG_PAGE_OFFSET;
+
+        m_ring = static_cast<kvm_dirty_gfn*>(mmap(NULL,
+                                                  size * sizeof(kvm_dirty_gfn),
+                                                  PROT_READ | PROT_WRITE,
+                                                  MAP_SHARED, vcpu_fd, offset));
+
+        if (m_ring == MAP_FAILED)
+            VMM_THROW(std::system_error(errno, std::system_category()));
+    }
+
+    DirtyRing::~DirtyRing()
+    {
+        if (m_ring)
+            munmap(m_ring, m_size * sizeof(kvm_dirty_gfn));
+    }
+
+    DirtyRing::DirtyRing(DirtyRing&& other) noexcept
+        : m_ring{other.m_ring}, m_size{other.m_size}, m_next{other.m_next}
+    {
+        other.m_ring = nullptr;
+    }
+
+    auto DirtyRing::operator=(DirtyRing&& other) noexcept -> DirtyRing&
+    {
+        if (&other == this)
+            return *this;
+
+        if (m_ring)
+            munmap(m_ring, m_size * sizeof(kvm_dirty_gfn));
+
+        m_ring = other.m_ring;
+        m_size = other.m_size;
+        m_next = other.m_next;
+        other.m_ring = nullptr;
+
+        return *this;
+    }
+
     Vcpu::Vcpu(int fd, std::size_t mmap_size)
         : m_fd{fd},
           m_mmap_size{mmap_size},
@@ -28,7 +91,36 @@ namespace vmm::kvm::detail {
     // See documentation for KVM_RUN.
     auto Vcpu::run() const -> VcpuExit
     {
-        m_fd.ioctl(KVM_RUN);
+#if defined(VMM_VCPU_STATS)
+        const auto start = std::chrono::steady_clock::now();
+        const auto record = [&](VcpuExit exit) {
+            const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count();
+
+            m_stats.record(exit, static_cast<uint64_t>(ns));
+
+            return exit;
+        };
+#else
+        const auto record = [](VcpuExit exit) { return exit; };
+#endif
+
+        // Record the running thread once so kick() can signal it out of
+        // KVM_RUN; a vCPU stays on the thread that first ran it.
+        if (!m_kick->attached.load(std::memory_order_relaxed)) {
+            m_kick->thread.store(pthread_self(), std::memory_order_relaxed);
+            m_kick->attached.store(true, std::memory_order_release);
+        }
+
+        // KVM_RUN is the hottest ioctl in the library; the non-throwing path
+        // keeps unwind codegen away from the loop, and an EINTR from a vCPU
+        // kick is reported as an ordinary Intr exit instead of a throw.
+        if (const auto ret = m_fd.try_ioctl(KVM_RUN); !ret) {
+            if (ret.error() == std::errc::interrupted)
+                return record(VcpuExit::Intr);
+
+            VMM_THROW(std::system_error(ret.error()));
+        }
 
         switch(m_run->exit_reason) {
             case KVM_EXIT_UNKNOWN:
@@ -60,173 +152,197 @@ namespace vmm::kvm::detail {
             case KVM_EXIT_IOAPIC_EOI:
             case KVM_EXIT_HYPERV:
             case KVM_EXIT_ARM_NISV:
-                return static_cast<VcpuExit>(m_run->exit_reason);
+                return record(static_cast<VcpuExit>(m_run->exit_reason));
             default:
                 VMM_THROW(std::runtime_error("Unexpected exit reason"));
         };
     }
 
-    auto Vcpu::data() const noexcept -> kvm_run*
+    auto Vcpu::coalesced_mmio_ring() const noexcept -> CoalescedMmioRing
     {
-        return m_run;
-    }
+        const auto page_size = sysconf(_SC_PAGESIZE);
 
-    auto Vcpu::immediate_exit() const noexcept -> uint8_t
-    {
-        return m_run->immediate_exit;
+        if (page_size <= 0)
+            return CoalescedMmioRing{};
+
+        const auto offset = static_cast<std::size_t>(page_size) *
+                            KVM_COALESCED_MMIO_PAGE_OFFSET;
+
+        // The ring occupies the page after kvm_run; an mmap area that stops
+        // short of it means the host lacks KVM_CAP_COALESCED_MMIO.
+        if (m_mmap_size < offset + static_cast<std::size_t>(page_size))
+            return CoalescedMmioRing{};
+
+        const auto ring = static_cast<kvm_coalesced_mmio_ring*>(
+            static_cast<void*>(reinterpret_cast<unsigned char*>(m_run) + offset));
+
+        const auto max = (static_cast<std::size_t>(page_size) -
+                          sizeof(kvm_coalesced_mmio_ring)) /
+                         sizeof(kvm_coalesced_mmio);
+
+        return CoalescedMmioRing{ring, static_cast<uint32_t>(max)};
     }
 
-    auto Vcpu::set_immediate_exit(uint8_t val) noexcept -> void
+    auto Vcpu::dirty_ring(uint32_t size) const -> DirtyRing
     {
-        m_run->immediate_exit = val;
+        return DirtyRing{m_fd.fd(),
+                         static_cast<uint32_t>(size / sizeof(kvm_dirty_gfn))};
     }
 
-#if defined(__i386__) || defined(__x86_64__)  || \
-    defined(__arm__)  || defined(__aarch64__)
-        auto Vcpu::mp_state() const -> kvm_mp_state
-        {
-            auto mp_state = kvm_mp_state{};
-            m_fd.ioctl(KVM_GET_MP_STATE, &mp_state);
-            return mp_state;
-        }
+    namespace {
+        // The handler body is empty on purpose: delivery exists only to
+        // interrupt KVM_RUN, and the EINTR return does the actual work.
+        auto kick_signal_handler(int) -> void {}
 
-        auto Vcpu::set_mp_state(const kvm_mp_state& mp_state) const -> void
-        {
-            m_fd.ioctl(KVM_SET_MP_STATE, &mp_state);
-        }
-#endif
+        // Signal installed by Vcpu::setup_kick_signal(); 0 until then.
+        std::atomic<int> kick_signal{0};
+    }
 
-#if defined(__i386__) || defined(__x86_64__)  || \
-    defined(__arm__)  || defined(__aarch64__)
-        auto Vcpu::vcpu_events() const -> kvm_vcpu_events
-        {
-            auto vcpu_events = kvm_vcpu_events{};
-            m_fd.ioctl(KVM_GET_VCPU_EVENTS, &vcpu_events);
-            return vcpu_events;
-        }
+    auto Vcpu::setup_kick_signal(int signum) -> void
+    {
+        struct sigaction action = {};
+        action.sa_handler = kick_signal_handler;
+        sigemptyset(&action.sa_mask);
 
-        auto Vcpu::set_vcpu_events(const kvm_vcpu_events& vcpu_events) const -> void
-        {
-            m_fd.ioctl(KVM_SET_VCPU_EVENTS, &vcpu_events);
-        }
-#endif
+        // Deliberately no SA_RESTART: KVM_RUN has to fail with EINTR
+        // rather than transparently resume.
+        action.sa_flags = 0;
 
-#if defined(__i386__) || defined(__x86_64__) || \
-    defined(__ppc__)  || defined(__ppc64__)
-        auto Vcpu::sregs() const -> kvm_sregs
-        {
-            auto sregs = kvm_sregs{};
-            m_fd.ioctl(KVM_GET_SREGS, &sregs);
-            return sregs;
-        }
+        if (sigaction(signum, &action, nullptr) < 0)
+            VMM_THROW(std::system_error(errno, std::system_category()));
 
-        auto Vcpu::set_sregs(const kvm_sregs& sregs) const -> void
-        {
-            m_fd.ioctl(KVM_SET_SREGS, &sregs);
-        }
-#endif
+        kick_signal.store(signum, std::memory_order_release);
+    }
 
-#if defined(__i386__) || defined(__x86_64__)
-        auto Vcpu::fpu() const -> kvm_fpu
-        {
-            auto fpu = kvm_fpu{};
-            m_fd.ioctl(KVM_GET_FPU, &fpu);
-            return fpu;
-        }
+    auto Vcpu::kick(uint32_t work) const noexcept -> void
+    {
+        // Publish the work before raising immediate_exit: a vCPU thread
+        // that observes the exit must also observe why it was kicked.
+        m_kick->pending.fetch_or(work, std::memory_order_release);
 
-        auto Vcpu::set_fpu(const kvm_fpu& fpu) const -> void
-        {
-            m_fd.ioctl(KVM_SET_FPU, &fpu);
-        }
+        // KVM checks immediate_exit on entry, which closes the window
+        // where the vCPU thread is past its own checks but has not yet
+        // reached KVM_RUN — the signal alone cannot cover that gap.
+        __atomic_store_n(&m_run->immediate_exit, uint8_t{1},
+                         __ATOMIC_RELEASE);
 
-        auto Vcpu::lapic() const -> kvm_lapic_state
-        {
-            auto lapic = kvm_lapic_state{};
-            m_fd.ioctl(KVM_GET_LAPIC, &lapic);
-            return lapic;
-        }
+        const auto signum = kick_signal.load(std::memory_order_acquire);
 
-        auto Vcpu::set_lapic(const kvm_lapic_state& lapic) const -> void
-        {
-            m_fd.ioctl(KVM_SET_LAPIC, &lapic);
-        }
+        if (signum != 0 && m_kick->attached.load(std::memory_order_acquire))
+            pthread_kill(m_kick->thread.load(std::memory_order_relaxed),
+                         signum);
+    }
 
-        auto Vcpu::xsave() const -> kvm_xsave
-        {
-            auto xsave = kvm_xsave{};
-            m_fd.ioctl(KVM_GET_XSAVE, &xsave);
-            return xsave;
+#if defined(__i386__) || defined(__x86_64__)
+        namespace {
+            // Runs `f(i)` for every index on its own thread, joining them
+            // all and rethrowing the first failure.
+            template<typename F>
+            auto for_each_parallel(std::size_t count, F f) -> void
+            {
+                auto error = std::exception_ptr{};
+                auto error_mutex = std::mutex{};
+                auto pool = std::vector<std::thread>{};
+                pool.reserve(count);
+
+                for (auto i = std::size_t{}; i < count; i++) {
+                    pool.emplace_back([&, i] {
+                        try {
+                            f(i);
+                        }
+                        catch (...) {
+                            const auto lock =
+                                std::lock_guard<std::mutex>{error_mutex};
+
+                            if (!error)
+                                error = std::current_exception();
+                        }
+                    });
+                }
+
+                for (auto& thread : pool)
+                    thread.join();
+
+                if (error)
+                    std::rethrow_exception(error);
+            }
         }
 
-        auto Vcpu::set_xsave(const kvm_xsave& xsave) const -> void
+        auto Vcpu::save(VcpuState& state,
+                        const MsrList<MAX_IO_MSRS>& indices) const -> void
         {
-            m_fd.ioctl(KVM_SET_XSAVE, &xsave);
-        }
+            state.regs = regs();
+            state.sregs = sregs();
+            state.fpu = fpu();
+            state.lapic = lapic();
+            state.xcrs = xcrs();
+            state.debug_regs = debug_regs();
+            state.events = vcpu_events();
+            state.mp_state = mp_state();
 
-        auto Vcpu::xcrs() const -> kvm_xcrs
-        {
-            auto xcrs = kvm_xcrs{};
-            m_fd.ioctl(KVM_GET_XCRS, &xcrs);
-            return xcrs;
-        }
+            const auto xsave = this->xsave();
+            std::memcpy(state.xsave, &xsave, sizeof(xsave));
 
-        auto Vcpu::set_xcrs(const kvm_xcrs& xcrs) const -> void
-        {
-            m_fd.ioctl(KVM_SET_XCRS, &xcrs);
-        }
+            auto msrs = Msrs<MAX_IO_MSRS>{};
+            msrs.data()->nmsrs = static_cast<uint32_t>(indices.size());
 
-        auto Vcpu::debug_regs() const -> kvm_debugregs
-        {
-            auto debug_regs = kvm_debugregs{};
-            m_fd.ioctl(KVM_GET_DEBUGREGS, &debug_regs);
-            return debug_regs;
-        }
+            for (auto i = std::size_t{}; i < indices.size(); i++)
+                msrs[i].index = indices[i];
 
-        auto Vcpu::set_debug_regs(const kvm_debugregs& debug_regs) const -> void
-        {
-            m_fd.ioctl(KVM_SET_DEBUGREGS, &debug_regs);
+            state.nmsrs = static_cast<uint32_t>(get_msrs(msrs));
+
+            std::memcpy(state.msrs, msrs.begin(),
+                        state.nmsrs * sizeof(kvm_msr_entry));
         }
-#endif
 
-#if defined(__arm__) || defined(__aarch64__)
-        auto Vcpu::init(const kvm_vcpu_init& init) const -> void
+        auto Vcpu::restore(const VcpuState& state) const -> void
         {
-            m_fd.ioctl(KVM_ARM_VCPU_INIT, init);
-        }
+            // Register and FPU state has to be in place before the MSRs and
+            // interrupt state that depend on it.
+            set_regs(state.regs);
+            set_sregs(state.sregs);
 
-        auto Vcpu::reg(uint64_t id) -> uint64_t {
-            auto value = uint64_t{};
-            auto reg = kvm_one_reg {
-                id,
-                reinterpret_cast<uintptr_t>(&value)
-            };
+            auto xsave = kvm_xsave{};
+            std::memcpy(&xsave, state.xsave, sizeof(xsave));
+            set_xsave(xsave);
 
-            m_fd.ioctl(KVM_GET_ONE_REG, &reg);
-            return value;
-        }
+            set_xcrs(state.xcrs);
+            set_fpu(state.fpu);
+            set_debug_regs(state.debug_regs);
 
-        auto Vcpu::set_reg(uint64_t id, uint64_t data) -> void {
-            auto reg = kvm_one_reg {
-                id,
-                reinterpret_cast<uintptr_t>(&data)
-            };
+            auto msrs = Msrs<MAX_IO_MSRS>{state.msrs,
+                                          state.msrs + state.nmsrs};
+            set_msrs(msrs);
 
-            m_fd.ioctl(KVM_SET_ONE_REG, &reg);
+            set_lapic(state.lapic);
+            set_vcpu_events(state.events);
+            set_mp_state(state.mp_state);
         }
 #endif
 
-#if !defined(__arm__) && !defined(__aarch64__)
-        auto Vcpu::regs() const -> kvm_regs
-        {
-            auto regs = kvm_regs{};
-            m_fd.ioctl(KVM_GET_REGS, &regs);
-            return regs;
-        }
-
-        auto Vcpu::set_regs(const kvm_regs& regs) const -> void
-        {
-            m_fd.ioctl(KVM_SET_REGS, &regs);
-        }
+#if defined(__i386__) || defined(__x86_64__)
+auto save_vcpus(const std::vector<Vcpu>& vcpus,
+                const MsrList<MAX_IO_MSRS>& indices) -> std::vector<VcpuState>
+{
+    auto states = std::vector<VcpuState>(vcpus.size());
+
+    for_each_parallel(vcpus.size(), [&](std::size_t i) {
+        vcpus[i].save(states[i], indices);
+    });
+
+    return states;
+}
+
+auto restore_vcpus(const std::vector<Vcpu>& vcpus,
+                   const std::vector<VcpuState>& states) -> void
+{
+    if (states.size() != vcpus.size())
+        VMM_THROW(std::runtime_error("vCPU state count mismatch"));
+
+    for_each_parallel(vcpus.size(), [&](std::size_t i) {
+        vcpus[i].restore(states[i]);
+    });
+}
 #endif
 
 }  // namespace vmm::kvm::detail
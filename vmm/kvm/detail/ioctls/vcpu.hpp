@@ -4,10 +4,14 @@
 
 #pragma once
 
+#include <atomic> // atomic
+#include <csignal> // SIGRTMIN
 #include <cstddef> // size_t
 #include <cstdint> // uint*_t
+#include <memory> // unique_ptr, make_unique
 
 #include <linux/kvm.h> // kvm_*, KVM_*
+#include <pthread.h> // pthread_t
 
 #include "vmm/kvm/detail/ioctls/vm.hpp"
 #include "vmm/kvm/detail/types/file_descriptor.hpp"
@@ -46,6 +50,421 @@ enum class VcpuExit: uint32_t {
     ArmNsiv,       // KVM_EXIT_HYPERV
 };
 
+enum class IoDirection : uint8_t {
+    In,  // KVM_EXIT_IO_IN
+    Out, // KVM_EXIT_IO_OUT
+};
+
+// A non-owning view of a KVM_EXIT_IO exit.
+//
+// The PIO data window lives inside the mmap'd kvm_run region at
+// `kvm_run::io.data_offset`; the view computes that offset once and hands
+// out pointers into the region, so servicing a PIO exit copies and
+// allocates nothing. The view is only valid until the next call to
+// `Vcpu::run()`.
+class IoExit
+{
+    public:
+        explicit IoExit(kvm_run* run) noexcept : m_run{run} {}
+
+        [[nodiscard]] auto direction() const noexcept -> IoDirection
+        {
+            return static_cast<IoDirection>(m_run->io.direction);
+        }
+
+        [[nodiscard]] auto port() const noexcept -> uint16_t
+        {
+            return m_run->io.port;
+        }
+
+        // Returns the width of a single access, in bytes.
+        [[nodiscard]] auto access_size() const noexcept -> uint8_t
+        {
+            return m_run->io.size;
+        }
+
+        // Returns the number of accesses in the data window (> 1 for string
+        // instructions).
+        [[nodiscard]] auto count() const noexcept -> uint32_t
+        {
+            return m_run->io.count;
+        }
+
+        // Returns the total length of the data window, in bytes.
+        [[nodiscard]] auto size() const noexcept -> std::size_t
+        {
+            return static_cast<std::size_t>(m_run->io.size) * m_run->io.count;
+        }
+
+        // Returns a pointer to the data window inside the kvm_run region.
+        [[nodiscard]] auto data() const noexcept -> uint8_t*
+        {
+            return reinterpret_cast<uint8_t*>(m_run) + m_run->io.data_offset;
+        }
+
+        [[nodiscard]] auto begin() const noexcept -> uint8_t*
+        {
+            return data();
+        }
+
+        [[nodiscard]] auto end() const noexcept -> uint8_t*
+        {
+            return data() + size();
+        }
+
+        [[nodiscard]] auto operator[](std::size_t pos) const noexcept -> uint8_t&
+        {
+            return data()[pos];
+        }
+    private:
+        kvm_run* m_run;
+};
+
+// A non-owning view of a KVM_EXIT_MMIO exit.
+//
+// The faulting address and the (up to 8-byte) data payload are read and
+// written in place in the kvm_run region. For reads (`!is_write()`), the
+// device's reply is written through `data()` before the next `Vcpu::run()`.
+class MmioExit
+{
+    public:
+        explicit MmioExit(kvm_run* run) noexcept : m_run{run} {}
+
+        // Returns the faulting guest physical address.
+        [[nodiscard]] auto addr() const noexcept -> uint64_t
+        {
+            return m_run->mmio.phys_addr;
+        }
+
+        [[nodiscard]] auto is_write() const noexcept -> bool
+        {
+            return m_run->mmio.is_write;
+        }
+
+        // Returns the length of the access, in bytes.
+        [[nodiscard]] auto size() const noexcept -> std::size_t
+        {
+            return m_run->mmio.len;
+        }
+
+        // Returns a pointer to the data payload inside the kvm_run region.
+        [[nodiscard]] auto data() const noexcept -> uint8_t*
+        {
+            return m_run->mmio.data;
+        }
+
+        [[nodiscard]] auto begin() const noexcept -> uint8_t*
+        {
+            return data();
+        }
+
+        [[nodiscard]] auto end() const noexcept -> uint8_t*
+        {
+            return data() + size();
+        }
+    private:
+        kvm_run* m_run;
+};
+
+// A drain view of the coalesced MMIO ring in the kvm_run mmap area.
+//
+// With KVM_CAP_COALESCED_MMIO, the kernel appends doorbell-style MMIO writes
+// to a ring one page into the vCPU's mmap region instead of exiting per
+// write. `drain()` consumes everything the kernel has published with one
+// acquire load of the producer index and one release store of the consumer
+// index, so a burst of writes costs a single exit and a single barrier pair.
+class CoalescedMmioRing
+{
+    public:
+        CoalescedMmioRing() noexcept = default;
+
+        CoalescedMmioRing(kvm_coalesced_mmio_ring* ring, uint32_t max) noexcept
+            : m_ring{ring}, m_max{max} {}
+
+        // Checks whether the vCPU's mmap area actually contains the ring.
+        [[nodiscard]] explicit operator bool() const noexcept
+        {
+            return m_ring != nullptr;
+        }
+
+        [[nodiscard]] auto empty() const noexcept -> bool
+        {
+            return m_ring == nullptr ||
+                   m_ring->first == __atomic_load_n(&m_ring->last,
+                                                    __ATOMIC_ACQUIRE);
+        }
+
+        // Invokes `f` on every entry the kernel has published, then releases
+        // the consumed slots back to the kernel in one batch. Returns the
+        // number of entries drained.
+        template<typename F>
+        auto drain(F&& f) -> std::size_t
+        {
+            if (m_ring == nullptr)
+                return 0;
+
+            const auto last = __atomic_load_n(&m_ring->last, __ATOMIC_ACQUIRE);
+            auto first = m_ring->first;
+            auto count = std::size_t{};
+
+            while (first != last) {
+                f(static_cast<const kvm_coalesced_mmio&>(m_ring->coalesced_mmio[first]));
+                first = (first + 1) % m_max;
+                count++;
+            }
+
+            __atomic_store_n(&m_ring->first, first, __ATOMIC_RELEASE);
+
+            return count;
+        }
+    private:
+        kvm_coalesced_mmio_ring* m_ring{};
+        uint32_t m_max{};
+};
+
+// A per-vCPU dirty ring (KVM_CAP_DIRTY_LOG_RING).
+//
+// The ring is an mmap'd array of kvm_dirty_gfn entries at
+// KVM_DIRTY_LOG_PAGE_OFFSET of the vCPU fd. The kernel appends a (slot, gfn)
+// entry whenever the guest dirties a page, so harvesting cost is
+// proportional to the dirty rate rather than to guest size; a full-slot
+// bitmap scan via `Vm::dirty_log()` is never needed. After collecting,
+// call `Vm::reset_dirty_rings()` to recycle the consumed entries.
+class DirtyRing
+{
+    public:
+        DirtyRing() noexcept = default;
+
+        // Maps a ring of `size` entries (a power of two). Note this is an
+        // entry count, not the byte size given to
+        // `Vm::enable_dirty_ring()`; `Vcpu::dirty_ring()` does the
+        // conversion.
+        DirtyRing(int vcpu_fd, uint32_t size);
+
+        ~DirtyRing();
+
+        DirtyRing(const DirtyRing&) = delete;
+        auto operator=(const DirtyRing&) -> DirtyRing& = delete;
+
+        DirtyRing(DirtyRing&& other) noexcept;
+        auto operator=(DirtyRing&& other) noexcept -> DirtyRing&;
+
+        [[nodiscard]] constexpr auto size() const noexcept -> uint32_t
+        {
+            return m_size;
+        }
+
+        // Harvests every published entry, invoking `f(slot, offset)` with
+        // the memslot id and the page offset within it. Consumed entries are
+        // flagged for reset; the kernel recycles them on the VM-wide
+        // KVM_RESET_DIRTY_RINGS ioctl. Returns the number of entries
+        // collected.
+        template<typename F>
+        auto collect(F&& f) noexcept -> std::size_t
+        {
+            auto count = std::size_t{};
+
+            for (;;) {
+                auto& entry = m_ring[m_next & (m_size - 1)];
+                const auto flags = __atomic_load_n(&entry.flags,
+                                                   __ATOMIC_ACQUIRE);
+
+                if (!(flags & KVM_DIRTY_GFN_F_DIRTY))
+                    break;
+
+                f(entry.slot, entry.offset);
+
+                __atomic_store_n(&entry.flags, flags | KVM_DIRTY_GFN_F_RESET,
+                                 __ATOMIC_RELEASE);
+
+                m_next++;
+                count++;
+            }
+
+            return count;
+        }
+    private:
+        kvm_dirty_gfn* m_ring{};
+        uint32_t m_size{};
+
+        // Next entry to examine (free-running; masked on access).
+        uint32_t m_next{};
+};
+
+#if defined(VMM_VCPU_STATS)
+// Number of VcpuExit reasons; sizes the statistics arrays below.
+constexpr std::size_t VCPU_EXIT_REASONS = 29;
+
+// Latency histogram buckets, log2 nanoseconds per bucket; the last bucket
+// absorbs anything at or past ~9 minutes.
+constexpr std::size_t VCPU_LATENCY_BUCKETS = 40;
+
+// A plain-value copy of a vCPU's statistics, safe to aggregate, diff, or
+// print after the vCPU that produced it has moved on.
+struct VcpuStatsSnapshot
+{
+    uint64_t exits[VCPU_EXIT_REASONS];
+    uint64_t latency[VCPU_EXIT_REASONS][VCPU_LATENCY_BUCKETS];
+};
+
+// Per-vCPU exit counters and optional per-exit latency histograms.
+//
+// Each vCPU owns one cache-line-aligned instance written only by its run
+// loop, so recording is an uncontended relaxed load/add/store — no lock
+// prefix, no shared cache line. A monitoring thread reads a coherent-enough
+// snapshot with relaxed loads while the vCPU keeps running; counters are
+// monotonic, so torn cross-counter views only misattribute in-flight exits.
+//
+// Only compiled in when the `vcpu_stats` meson option is enabled; without
+// it, `Vcpu::run()` carries no instrumentation at all.
+class alignas(64) VcpuStats
+{
+    public:
+        VcpuStats() noexcept = default;
+
+        VcpuStats(const VcpuStats& other) noexcept
+        {
+            copy_from(other);
+        }
+
+        auto operator=(const VcpuStats& other) noexcept -> VcpuStats&
+        {
+            copy_from(other);
+            return *this;
+        }
+
+        // Enables the per-exit latency histograms; exit counters alone are
+        // always recorded.
+        auto set_latency_enabled(bool enabled) noexcept -> void
+        {
+            m_latency_enabled = enabled;
+        }
+
+        [[nodiscard]] auto latency_enabled() const noexcept -> bool
+        {
+            return m_latency_enabled;
+        }
+
+        // Records one exit; called from the owning vCPU's run loop.
+        auto record(VcpuExit exit, uint64_t ns) noexcept -> void
+        {
+            const auto reason = static_cast<std::size_t>(exit);
+
+            if (reason >= VCPU_EXIT_REASONS)
+                return;
+
+            bump(m_exits[reason]);
+
+            if (m_latency_enabled)
+                bump(m_latency[reason][bucket(ns)]);
+        }
+
+        // Copies the counters out with relaxed loads; never blocks the vCPU.
+        [[nodiscard]] auto snapshot() const noexcept -> VcpuStatsSnapshot
+        {
+            auto copy = VcpuStatsSnapshot{};
+
+            for (auto i = std::size_t{}; i < VCPU_EXIT_REASONS; i++) {
+                copy.exits[i] = m_exits[i].load(std::memory_order_relaxed);
+
+                for (auto j = std::size_t{}; j < VCPU_LATENCY_BUCKETS; j++)
+                    copy.latency[i][j] =
+                        m_latency[i][j].load(std::memory_order_relaxed);
+            }
+
+            return copy;
+        }
+    private:
+        // Single writer: a relaxed load/add/store beats a locked fetch_add.
+        static auto bump(std::atomic<uint64_t>& counter) noexcept -> void
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] static auto bucket(uint64_t ns) noexcept -> std::size_t
+        {
+            const auto log2 = static_cast<std::size_t>(
+                63 - __builtin_clzll(ns | 1));
+
+            return log2 < VCPU_LATENCY_BUCKETS ? log2
+                                               : VCPU_LATENCY_BUCKETS - 1;
+        }
+
+        auto copy_from(const VcpuStats& other) noexcept -> void
+        {
+            for (auto i = std::size_t{}; i < VCPU_EXIT_REASONS; i++) {
+                m_exits[i].store(
+                    other.m_exits[i].load(std::memory_order_relaxed),
+                    std::memory_order_relaxed);
+
+                for (auto j = std::size_t{}; j < VCPU_LATENCY_BUCKETS; j++)
+                    m_latency[i][j].store(
+                        other.m_latency[i][j].load(std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+            }
+
+            m_latency_enabled = other.m_latency_enabled;
+        }
+
+        std::atomic<uint64_t> m_exits[VCPU_EXIT_REASONS]{};
+        std::atomic<uint64_t> m_latency[VCPU_EXIT_REASONS]
+                                       [VCPU_LATENCY_BUCKETS]{};
+        bool m_latency_enabled = false;
+};
+#endif
+
+#if defined(__i386__) || defined(__x86_64__)
+// A trivially-copyable capture of one vCPU's architectural state.
+//
+// The layout is self-contained and fixed-size, so a checkpoint can write
+// the struct (or an array of them) to disk or over a socket byte-for-byte;
+// only the first `nmsrs` entries of `msrs` are meaningful.
+struct VcpuState
+{
+    kvm_regs regs;
+    kvm_sregs sregs;
+    kvm_fpu fpu;
+    kvm_lapic_state lapic;
+
+    // Raw bytes of the fixed-size xsave area. kvm_xsave ends in a flexible
+    // array member (used only by KVM_GET_XSAVE2, which this path does not
+    // issue), so the struct itself cannot be embedded here.
+    alignas(alignof(kvm_xsave)) uint8_t xsave[sizeof(kvm_xsave)];
+
+    kvm_xcrs xcrs;
+    kvm_debugregs debug_regs;
+    kvm_vcpu_events events;
+    kvm_mp_state mp_state;
+
+    uint32_t nmsrs;
+    kvm_msr_entry msrs[MAX_IO_MSRS];
+};
+#endif
+
+// Pending-work bits for `Vcpu::kick()`. The low bits carry the reasons the
+// library itself kicks for; callers attach their own meanings starting at
+// VCPU_KICK_USER.
+constexpr uint32_t VCPU_KICK_WAKE = 1u << 0;  // re-check state, no specific work
+constexpr uint32_t VCPU_KICK_PAUSE = 1u << 1; // stop-the-world pause request
+constexpr uint32_t VCPU_KICK_USER = 1u << 16; // first caller-defined bit
+
+// Shared state behind `Vcpu::kick()`.
+//
+// Heap-allocated so the atomics keep a stable address when the Vcpu object
+// moves (kickers race against them from other threads).
+struct KickState
+{
+    // Why the vCPU was kicked; bits ORed in by kickers and drained by the
+    // vCPU thread via `Vcpu::take_pending()`.
+    std::atomic<uint32_t> pending{};
+
+    // The thread running this vCPU; valid once `attached` is set by the
+    // first `Vcpu::run()`.
+    std::atomic<pthread_t> thread{};
+    std::atomic<bool> attached{};
+};
+
 class Vcpu
 {
     private:
@@ -53,29 +472,145 @@ class Vcpu
         std::size_t m_mmap_size;
         kvm_run *m_run = nullptr;
 
+#if defined(__i386__) || defined(__x86_64__)
+        // Whether register state is mirrored through m_run->s.regs
+        // (KVM_CAP_SYNC_REGS) instead of per-call ioctls.
+        bool m_sync_regs = false;
+#endif
+
+#if defined(VMM_VCPU_STATS)
+        // Exit statistics, written by run(); see VcpuStats.
+        mutable VcpuStats m_stats{};
+#endif
+
+        // Cross-thread kick state; see KickState.
+        std::unique_ptr<KickState> m_kick = std::make_unique<KickState>();
+
         friend Vcpu Vm::vcpu(int vcpu_id) const;
 
         explicit Vcpu(int fd, std::size_t mmap_size);
     public:
         [[nodiscard]] auto run() const -> VcpuExit;
-        [[nodiscard]] auto data() const noexcept -> kvm_run*;
+
+#if defined(VMM_VCPU_STATS)
+        // Returns this vCPU's statistics slot; `stats().snapshot()` is the
+        // monitoring-side read path.
+        [[nodiscard]] auto stats() const noexcept -> VcpuStats&
+        {
+            return m_stats;
+        }
+#endif
+        [[nodiscard]] auto data() const noexcept -> kvm_run*
+        {
+            return m_run;
+        }
+
+        // Returns a typed view of the current KVM_EXIT_IO exit. Only
+        // meaningful after `run()` returned VcpuExit::Io.
+        [[nodiscard]] auto io() const noexcept -> IoExit
+        {
+            return IoExit{m_run};
+        }
+
+        // Returns a typed view of the current KVM_EXIT_MMIO exit. Only
+        // meaningful after `run()` returned VcpuExit::Mmio.
+        [[nodiscard]] auto mmio() const noexcept -> MmioExit
+        {
+            return MmioExit{m_run};
+        }
+
+        // Returns a drain view of the coalesced MMIO ring; an empty view if
+        // the vCPU's mmap area does not cover the ring page (i.e. the host
+        // lacks KVM_CAP_COALESCED_MMIO).
+        [[nodiscard]] auto coalesced_mmio_ring() const noexcept -> CoalescedMmioRing;
+
+        // Maps and returns this vCPU's dirty ring. `size` is the ring size
+        // in bytes — the same value passed to `Vm::enable_dirty_ring()` —
+        // and is converted to an entry count internally. The VM must have
+        // enabled KVM_CAP_DIRTY_LOG_RING before any vCPU was created.
+        [[nodiscard]] auto dirty_ring(uint32_t size) const -> DirtyRing;
 
         // Returns the immediate_exit flag in m_run.
-        [[nodiscard]] auto immediate_exit() const noexcept -> uint8_t;
+        [[nodiscard]] auto immediate_exit() const noexcept -> uint8_t
+        {
+            return m_run->immediate_exit;
+        }
 
         // Sets the immediate_exit flag in m_run.
-        auto set_immediate_exit(uint8_t val) noexcept -> void;
+        auto set_immediate_exit(uint8_t val) noexcept -> void
+        {
+            m_run->immediate_exit = val;
+        }
+
+        // Installs the process-wide handler for the vCPU kick signal
+        // (default SIGRTMIN). Call once, before any `kick()`; until then a
+        // kick only arms the immediate-exit flag and cannot break a KVM_RUN
+        // that is already in progress.
+        static auto setup_kick_signal(int signum = SIGRTMIN) -> void;
+
+        // Interrupts this vCPU from another thread.
+        //
+        // ORs `work` into the pending-work mask, raises
+        // `m_run->immediate_exit` so a KVM_RUN entered after this point
+        // returns at once, and signals the vCPU thread so a KVM_RUN already
+        // in progress is broken out of with EINTR (surfacing as
+        // VcpuExit::Intr). Safe to call from any number of threads
+        // concurrently; never blocks and never takes a lock.
+        auto kick(uint32_t work = VCPU_KICK_WAKE) const noexcept -> void;
+
+        // Drains and returns the pending-work mask and rearms the
+        // immediate-exit flag; called on the vCPU thread after `run()`
+        // returns. A zero result means the exit was not caused by a kick
+        // (or the kick's work was already drained — treat it as spurious).
+        auto take_pending() const noexcept -> uint32_t
+        {
+            // Rearm before draining. With this order a kick that lands in
+            // between leaves immediate_exit raised with no work behind it —
+            // a spurious exit; the reverse order could leave work behind
+            // with the flag cleared — a lost wakeup.
+            __atomic_store_n(&m_run->immediate_exit, uint8_t{0},
+                             __ATOMIC_RELAXED);
+
+            return m_kick->pending.exchange(0, std::memory_order_acquire);
+        }
+
+        // Peeks at the pending-work mask without draining it.
+        [[nodiscard]] auto pending() const noexcept -> uint32_t
+        {
+            return m_kick->pending.load(std::memory_order_acquire);
+        }
 
 #if !defined(__arm__) && !defined(__aarch64__)
         // Returns the vCPU general purpose registers.
         //
         // See documentation for KVM_GET_REGS.
-        [[nodiscard]] auto regs() const -> kvm_regs;
+        [[nodiscard]] auto regs() const -> kvm_regs
+        {
+#if defined(__i386__) || defined(__x86_64__)
+            if (m_sync_regs)
+                return m_run->s.regs.regs;
+#endif
+
+            auto regs = kvm_regs{};
+            m_fd.ioctl(KVM_GET_REGS, &regs);
+            return regs;
+        }
 
         // Sets the vCPU's general purpose registers.
         //
         // See documentation for KVM_SET_REGS.
-        auto set_regs(const kvm_regs&) const -> void;
+        auto set_regs(const kvm_regs& regs) const -> void
+        {
+#if defined(__i386__) || defined(__x86_64__)
+            if (m_sync_regs) {
+                m_run->s.regs.regs = regs;
+                m_run->kvm_dirty_regs |= KVM_SYNC_X86_REGS;
+                return;
+            }
+#endif
+
+            m_fd.ioctl(KVM_SET_REGS, &regs);
+        }
 #endif
 
 #if defined(__i386__) || defined(__x86_64__)  || \
@@ -83,12 +618,20 @@ class Vcpu
         // Returns the vCPU's current "multiprocessing state".
         //
         // See the documentation for KVM_GET_MP_STATE.
-        [[nodiscard]] auto mp_state() const -> kvm_mp_state;
+        [[nodiscard]] auto mp_state() const -> kvm_mp_state
+        {
+            auto mp_state = kvm_mp_state{};
+            m_fd.ioctl(KVM_GET_MP_STATE, &mp_state);
+            return mp_state;
+        }
 
         // Sets the vCPU's current "multiprocessing state".
         //
         // See the documentation for KVM_SET_MP_STATE.
-        auto set_mp_state(const kvm_mp_state&) const -> void;
+        auto set_mp_state(const kvm_mp_state& mp_state) const -> void
+        {
+            m_fd.ioctl(KVM_SET_MP_STATE, &mp_state);
+        }
 #endif
 
 #if defined(__i386__) || defined(__x86_64__)  || \
@@ -97,13 +640,21 @@ class Vcpu
         // as related states of the vCPU.
         //
         // See the documentation for KVM_GET_VCPU_EVENTS.
-        [[nodiscard]] auto vcpu_events() const -> kvm_vcpu_events;
+        [[nodiscard]] auto vcpu_events() const -> kvm_vcpu_events
+        {
+            auto vcpu_events = kvm_vcpu_events{};
+            m_fd.ioctl(KVM_GET_VCPU_EVENTS, &vcpu_events);
+            return vcpu_events;
+        }
 
         // Sets pending exceptions, interrupts, and NMIs as well as related
         // states of the vcpu.
         //
         // See the documentation for KVM_SET_VCPU_EVENTS.
-        auto set_vcpu_events(const kvm_vcpu_events&) const -> void;
+        auto set_vcpu_events(const kvm_vcpu_events& vcpu_events) const -> void
+        {
+            m_fd.ioctl(KVM_SET_VCPU_EVENTS, &vcpu_events);
+        }
 #endif
 
 #if defined(__i386__) || defined(__x86_64__) || \
@@ -111,66 +662,164 @@ class Vcpu
         // Returns special registers of the vCPU.
         //
         // See the documentation for KVM_GET_SREGS.
-        [[nodiscard]] auto sregs() const -> kvm_sregs;
+        [[nodiscard]] auto sregs() const -> kvm_sregs
+        {
+#if defined(__i386__) || defined(__x86_64__)
+            if (m_sync_regs)
+                return m_run->s.regs.sregs;
+#endif
+
+            auto sregs = kvm_sregs{};
+            m_fd.ioctl(KVM_GET_SREGS, &sregs);
+            return sregs;
+        }
 
         // Sets special registers of the vCPU.
         //
         // See the documentation for KVM_SET_SREGS.
-        auto set_sregs(const kvm_sregs&) const -> void;
+        auto set_sregs(const kvm_sregs& sregs) const -> void
+        {
+#if defined(__i386__) || defined(__x86_64__)
+            if (m_sync_regs) {
+                m_run->s.regs.sregs = sregs;
+                m_run->kvm_dirty_regs |= KVM_SYNC_X86_SREGS;
+                return;
+            }
+#endif
+
+            m_fd.ioctl(KVM_SET_SREGS, &sregs);
+        }
 #endif
 
 #if defined(__i386__) || defined(__x86_64__)
+        // Enables or disables register synchronization through the kvm_run
+        // mmap area (KVM_CAP_SYNC_REGS).
+        //
+        // While enabled, KVM mirrors general purpose and special registers
+        // into `m_run->s.regs` on every KVM_RUN, and `regs()`/`set_regs()`
+        // (and the sregs equivalents) operate on the mirror with dirty-bit
+        // tracking instead of issuing GET/SET ioctls per call. Callers must
+        // verify the capability with `check_extension(KVM_CAP_SYNC_REGS)`
+        // before enabling; reads are valid after the first `run()`.
+        auto set_sync_regs(bool enable) noexcept -> void
+        {
+            m_sync_regs = enable;
+
+            if (enable) {
+                m_run->kvm_valid_regs = KVM_SYNC_X86_REGS | KVM_SYNC_X86_SREGS;
+            }
+            else {
+                m_run->kvm_valid_regs = 0;
+                m_run->kvm_dirty_regs = 0;
+            }
+        }
+
+        // Checks whether sync-regs mode is enabled.
+        [[nodiscard]] auto sync_regs_enabled() const noexcept -> bool
+        {
+            return m_sync_regs;
+        }
+
         // Returns the floating point state (FPU) of the vCPU.
         //
         // See the documentation for KVM_GET_FPU.
-        [[nodiscard]] auto fpu() const -> kvm_fpu;
+        [[nodiscard]] auto fpu() const -> kvm_fpu
+        {
+            auto fpu = kvm_fpu{};
+            m_fd.ioctl(KVM_GET_FPU, &fpu);
+            return fpu;
+        }
 
         // Sets the floating point state (FPU) of the vCPU.
         //
         // See the documentation for KVM_SET_FPU.
-        auto set_fpu(const kvm_fpu&) const -> void;
+        auto set_fpu(const kvm_fpu& fpu) const -> void
+        {
+            m_fd.ioctl(KVM_SET_FPU, &fpu);
+        }
 
         // Returns the state of the Local Advanced Programmable Interrupt
         // Controller (LAPIC).
         //
         // See the documentation for KVM_GET_LAPIC.
-        [[nodiscard]] auto lapic() const -> kvm_lapic_state;
+        [[nodiscard]] auto lapic() const -> kvm_lapic_state
+        {
+            auto lapic = kvm_lapic_state{};
+            m_fd.ioctl(KVM_GET_LAPIC, &lapic);
+            return lapic;
+        }
 
         // Sets the state of the Local Advanced Programmable Interrupt
         // Controller (LAPIC).
         //
         // See the documentation for KVM_SET_LAPIC.
-        auto set_lapic(const kvm_lapic_state&) const -> void;
+        auto set_lapic(const kvm_lapic_state& lapic) const -> void
+        {
+            m_fd.ioctl(KVM_SET_LAPIC, &lapic);
+        }
 
         // Returns the vCPU's current xsave struct.
         //
         // See the documentation for KVM_GET_XSAVE.
-        [[nodiscard]] auto xsave() const -> kvm_xsave;
+        [[nodiscard]] auto xsave() const -> kvm_xsave
+        {
+            auto xsave = kvm_xsave{};
+            m_fd.ioctl(KVM_GET_XSAVE, &xsave);
+            return xsave;
+        }
 
         // Sets the vCPU's current xsave struct.
         //
         // See the documentation for KVM_SET_XSAVE.
-        auto set_xsave(const kvm_xsave&) const -> void;
+        auto set_xsave(const kvm_xsave& xsave) const -> void
+        {
+            m_fd.ioctl(KVM_SET_XSAVE, &xsave);
+        }
 
         // Returns the vCPU's current xcrs struct.
         //
         // See the documentation for KVM_GET_XCRS.
-        [[nodiscard]] auto xcrs() const -> kvm_xcrs;
+        [[nodiscard]] auto xcrs() const -> kvm_xcrs
+        {
+            auto xcrs = kvm_xcrs{};
+            m_fd.ioctl(KVM_GET_XCRS, &xcrs);
+            return xcrs;
+        }
 
         // Sets the vCPU's current xcrs struct.
         //
         // See the documentation for KVM_SET_XCRS.
-        auto set_xcrs(const kvm_xcrs&) const -> void;
+        auto set_xcrs(const kvm_xcrs& xcrs) const -> void
+        {
+            m_fd.ioctl(KVM_SET_XCRS, &xcrs);
+        }
 
         // Returns vCPU's current debug registers.
         //
         // See the documentation for KVM_GET_DEBUGREGS.
-        [[nodiscard]] auto debug_regs() const -> kvm_debugregs;
+        [[nodiscard]] auto debug_regs() const -> kvm_debugregs
+        {
+            auto debug_regs = kvm_debugregs{};
+            m_fd.ioctl(KVM_GET_DEBUGREGS, &debug_regs);
+            return debug_regs;
+        }
 
         // Sets the vCPU's current debug registers.
         //
         // See the documentation for KVM_SET_DEBUGREGS.
-        auto set_debug_regs(const kvm_debugregs&) const -> void;
+        auto set_debug_regs(const kvm_debugregs& debug_regs) const -> void
+        {
+            m_fd.ioctl(KVM_SET_DEBUGREGS, &debug_regs);
+        }
+
+        // Captures the vCPU's architectural state with one tight ioctl
+        // sequence into the caller's preallocated buffer; `indices` selects
+        // the MSRs to capture (normally `System::features().msr_indices`).
+        auto save(VcpuState& state, const MsrList<MAX_IO_MSRS>& indices) const -> void;
+
+        // Restores state captured by `save()`, in the ordering KVM expects
+        // (registers and FPU state before interrupt state).
+        auto restore(const VcpuState& state) const -> void;
 
         // Reads MSRs from the vcpu. Returns the number of successfully read
         // values.
@@ -224,18 +873,53 @@ class Vcpu
         // features and resets the values of all of its registers to defaults.
         //
         // See the documentation for KVM_ARM_VCPU_INIT.
-        auto init(const kvm_vcpu_init&) const -> void;
+        auto init(const kvm_vcpu_init& init) const -> void
+        {
+            m_fd.ioctl(KVM_ARM_VCPU_INIT, init);
+        }
 
         // Returns the value of the specified vCPU register.
         //
         // See the documentation for KVM_GET_ONE_REG.
-        [[nodiscard]] auto reg(uint64_t id) -> uint64_t;
+        [[nodiscard]] auto reg(uint64_t id) -> uint64_t
+        {
+            auto value = uint64_t{};
+            auto reg = kvm_one_reg {
+                id,
+                reinterpret_cast<uintptr_t>(&value)
+            };
+
+            m_fd.ioctl(KVM_GET_ONE_REG, &reg);
+            return value;
+        }
 
         // Sets the value of one register for this vCPU.
         //
         // See the documentation for KVM_SET_ONE_REG.
-        auto set_reg(uint64_t id, uint64_t data) -> void;
+        auto set_reg(uint64_t id, uint64_t data) -> void
+        {
+            auto reg = kvm_one_reg {
+                id,
+                reinterpret_cast<uintptr_t>(&data)
+            };
+
+            m_fd.ioctl(KVM_SET_ONE_REG, &reg);
+        }
 #endif
 };
 
+#if defined(__i386__) || defined(__x86_64__)
+// Captures every vCPU's state in parallel, one thread per vCPU; the result
+// is indexed like `vcpus` (as returned by `Vm::vcpus()`). Checkpoint
+// capture time becomes that of the slowest single vCPU rather than the sum.
+[[nodiscard]] auto save_vcpus(const std::vector<Vcpu>& vcpus,
+                              const MsrList<MAX_IO_MSRS>& indices)
+    -> std::vector<VcpuState>;
+
+// Restores every vCPU's state in parallel; `states` must be indexed like
+// `vcpus`.
+auto restore_vcpus(const std::vector<Vcpu>& vcpus,
+                   const std::vector<VcpuState>& states) -> void;
+#endif
+
 }  // namespace vmm::kvm::detail
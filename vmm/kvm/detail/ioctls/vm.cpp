@@ -2,6 +2,13 @@
 // vm.cpp - VM ioctls
 //
 
+#include <algorithm> // min
+#include <atomic> // atomic
+#include <exception> // exception_ptr
+#include <mutex> // mutex, lock_guard
+#include <optional> // optional
+#include <thread> // thread
+
 #include <unistd.h> // sysconf, _SC_PAGESIZE
 
 #include "vmm/kvm/detail/ioctls/vm.hpp"
@@ -16,48 +23,79 @@ auto Vm::vcpu(int vcpu_id) const -> vmm::kvm::detail::Vcpu
                                   m_mmap_size};
 }
 
-auto Vm::device(uint32_t type, uint32_t flags) const -> vmm::kvm::detail::Device
+auto Vm::vcpus(int count) const -> std::vector<vmm::kvm::detail::Vcpu>
 {
-    auto dev = kvm_create_device{};
-    dev.type = type;
-    dev.flags = flags;
+    auto vcpus = std::vector<vmm::kvm::detail::Vcpu>{};
 
-    m_fd.ioctl(KVM_CREATE_DEVICE, &dev);
+    if (count <= 0)
+        return vcpus;
 
-    return vmm::kvm::detail::Device{dev};
-}
+    const auto total = static_cast<std::size_t>(count);
+    auto slots = std::vector<std::optional<vmm::kvm::detail::Vcpu>>(total);
 
-auto Vm::check_extension(int cap) const -> int
-{
-    return m_fd.ioctl(KVM_CHECK_EXTENSION, cap);
-}
+    // KVM_CREATE_VCPU serializes on the VM lock in the kernel, but the
+    // kvm_run mmap and any per-vcpu setup it gates run concurrently.
+    auto next = std::atomic<int>{0};
+    auto failed = std::atomic<bool>{false};
+    auto error = std::exception_ptr{};
+    auto error_mutex = std::mutex{};
 
-auto Vm::set_num_mmu_pages(int n) const -> void {
-    m_fd.ioctl(KVM_SET_NR_MMU_PAGES, n);
-}
+    const auto worker = [&] {
+        for (;;) {
+            const auto id = next.fetch_add(1, std::memory_order_relaxed);
 
-auto Vm::num_mmu_pages() const -> std::size_t {
-    return static_cast<std::size_t>(m_fd.ioctl(KVM_GET_NR_MMU_PAGES));
-}
+            if (id >= count || failed.load(std::memory_order_relaxed))
+                return;
 
-auto Vm::set_memslot(kvm_userspace_memory_region &region) const -> void
-{
-    m_fd.ioctl(KVM_SET_USER_MEMORY_REGION, &region);
+            try {
+                slots[static_cast<std::size_t>(id)].emplace(vcpu(id));
+            }
+            catch (...) {
+                const auto lock = std::lock_guard<std::mutex>{error_mutex};
+
+                if (!error)
+                    error = std::current_exception();
+
+                failed.store(true, std::memory_order_relaxed);
+                return;
+            }
+        }
+    };
+
+    const auto concurrency = std::thread::hardware_concurrency();
+    const auto pool_size = std::min(total,
+                                    static_cast<std::size_t>(
+                                        concurrency ? concurrency : 1));
+
+    auto pool = std::vector<std::thread>{};
+    pool.reserve(pool_size);
+
+    for (auto i = std::size_t{}; i < pool_size; i++)
+        pool.emplace_back(worker);
+
+    for (auto& thread : pool)
+        thread.join();
+
+    if (error)
+        std::rethrow_exception(error);
+
+    vcpus.reserve(total);
+
+    for (auto& slot : slots)
+        vcpus.push_back(std::move(*slot));
+
+    return vcpus;
 }
 
-auto Vm::set_memslot(uint32_t slot, uintptr_t guest_addr,
-                     uint64_t mem_size, uintptr_t user_addr,
-                     uint32_t flags) const -> void
+auto Vm::device(uint32_t type, uint32_t flags) const -> vmm::kvm::detail::Device
 {
-    auto mem_region = kvm_userspace_memory_region {
-        slot,
-        flags,
-        guest_addr,
-        mem_size,
-        user_addr,
-    };
+    auto dev = kvm_create_device{};
+    dev.type = type;
+    dev.flags = flags;
 
-    set_memslot(mem_region);
+    m_fd.ioctl(KVM_CREATE_DEVICE, &dev);
+
+    return vmm::kvm::detail::Device{dev};
 }
 
 auto Vm::dirty_log(uint32_t slot,
@@ -81,131 +119,4 @@ auto Vm::dirty_log(uint32_t slot,
     return bitmap;
 }
 
-auto Vm::mmap_size() const -> std::size_t
-{
-    return m_mmap_size;
-}
-
-auto Vm::num_vcpus() const -> int
-{
-    auto ret = check_extension(KVM_CAP_NR_VCPUS);
-    return ret > 0 ? ret : 4;
-}
-
-auto Vm::max_vcpus() const -> int
-{
-    auto ret = check_extension(KVM_CAP_MAX_VCPUS);
-    return ret > 0 ? ret : num_vcpus();
-}
-
-auto Vm::num_memslots() const -> int
-{
-    auto ret = check_extension(KVM_CAP_NR_MEMSLOTS);
-    return ret > 0 ? ret : 32;
-}
-
-#if defined(__i386__) || defined(__x86_64__)  || \
-    defined(__arm__)  || defined(__aarch64__)
-auto Vm::irqchip() const -> void
-{
-    m_fd.ioctl(KVM_CREATE_IRQCHIP);
-}
-
-auto Vm::register_irqfd(vmm::types::EventFd eventfd, uint32_t gsi) const -> void
-{
-    auto irqfd = kvm_irqfd {
-        static_cast<uint32_t>(eventfd.fd()),
-        gsi
-    };
-
-    m_fd.ioctl(KVM_IRQFD, &irqfd);
-}
-
-auto Vm::unregister_irqfd(vmm::types::EventFd eventfd, uint32_t gsi) const -> void
-{
-    auto irqfd = kvm_irqfd {
-        static_cast<uint32_t>(eventfd.fd()),
-        gsi,
-        KVM_IRQFD_FLAG_DEASSIGN
-    };
-
-    m_fd.ioctl(KVM_IRQFD, &irqfd);
-}
-#endif
-
-#if defined(__i386__) || defined(__x86_64__)  || \
-    defined(__arm__)  || defined(__aarch64__)
-auto Vm::set_irq_line(const uint32_t irq, IrqLevel level) const -> void
-{
-    auto irq_level = kvm_irq_level {
-        { irq },
-        static_cast<uint32_t>(level)
-    };
-
-    m_fd.ioctl(KVM_IRQ_LINE, &irq_level);
-}
-
-auto Vm::signal_msi(const kvm_msi &msi) const -> int {
-    return m_fd.ioctl(KVM_SIGNAL_MSI, &msi);
-}
-#endif
-
-#if defined(__i386__) || defined(__x86_64__)
-auto Vm::set_bsp(int vcpu_id) const -> void
-{
-    m_fd.ioctl(KVM_SET_BOOT_CPU_ID, vcpu_id);
-}
-
-auto Vm::get_irqchip(kvm_irqchip &irqchip_p) const -> void
-{
-    m_fd.ioctl(KVM_GET_IRQCHIP, &irqchip_p);
-}
-
-auto Vm::set_irqchip(const kvm_irqchip &irqchip_p) const -> void
-{
-    m_fd.ioctl(KVM_SET_IRQCHIP, &irqchip_p);
-}
-
-auto Vm::get_clock() const -> kvm_clock_data
-{
-    auto clock = kvm_clock_data{};
-    m_fd.ioctl(KVM_GET_CLOCK, &clock);
-    return clock;
-}
-
-auto Vm::set_clock(const kvm_clock_data &clock) const -> void
-{
-    m_fd.ioctl(KVM_SET_CLOCK, &clock);
-}
-
-auto Vm::set_tss_address(unsigned long address) const -> void {
-    m_fd.ioctl(KVM_SET_TSS_ADDR, address);
-}
-
-auto Vm::create_pit2(uint32_t flags) const -> void {
-    auto config = kvm_pit_config{};
-    config.flags = flags;
-    m_fd.ioctl(KVM_CREATE_PIT2, &config);
-}
-
-auto Vm::pit2() const -> kvm_pit_state2 {
-    auto state = kvm_pit_state2{};
-    m_fd.ioctl(KVM_GET_PIT2, &state);
-    return state;
-}
-
-auto Vm::set_pit2(const kvm_pit_state2 &state) const -> void {
-    m_fd.ioctl(KVM_SET_PIT2, &state);
-}
-#endif
-
-#if defined(__arm__) || defined(__aarch64__)
-auto Vm::preferred_target() const -> kvm_vcpu_init
-{
-    auto kvi = kvm_vcpu_init{};
-    m_fd.ioctl(KVM_ARM_PREFERRED_TARGET, &kvi);
-    return kvi;
-}
-#endif
-
 }  // namespace vmm::kvm::detail
@@ -4,14 +4,18 @@
 
 #pragma once
 
+#include <algorithm> // lower_bound
 #include <cstddef> // size_t
 #include <cstdint> // uint32_t, uint64_t
+#include <cstring> // memcmp
+#include <stdexcept> // overflow_error
 #include <linux/kvm.h> // kvm_*, KVM_*
 #include <vector> // vector
 
 #include "vmm/kvm/detail/ioctls/system.hpp"
 #include "vmm/kvm/detail/types/file_descriptor.hpp"
 #include "vmm/kvm/detail/types/fam_struct.hpp"
+#include "vmm/memory/detail/guest.hpp"
 #include "vmm/types/event.hpp"
 
 namespace vmm::kvm::detail {
@@ -41,13 +45,24 @@ class Vm
         auto operator=(Vm&& other) -> Vm& = default;
 
         // Returns the VM's kvm_run's shared memory region size.
-        [[nodiscard]] auto mmap_size() const -> std::size_t;
+        [[nodiscard]] auto mmap_size() const -> std::size_t
+        {
+            return m_mmap_size;
+        }
 
         // Adds a vcpu to a virtual machine.
         //
         // See the documentation for KVM_CREATE_VCPU.
         [[nodiscard]] auto vcpu(int vcpu_id) const -> vmm::kvm::detail::Vcpu;
 
+        // Adds vcpus 0 through `count - 1` to a virtual machine, spreading
+        // the KVM_CREATE_VCPU + kvm_run mmap sequences across a thread pool.
+        //
+        // Large guests boot noticeably faster this way: creating one vcpu at
+        // a time serializes every mmap and setup ioctl on one thread. The
+        // returned vcpus are ordered by id.
+        [[nodiscard]] auto vcpus(int count) const -> std::vector<vmm::kvm::detail::Vcpu>;
+
         // Adds a device to a virtual machine.
         //
         // See the documentation for KVM_CREATE_DEVICE.
@@ -59,26 +74,58 @@ class Vm
         // Based on their initialization, VMs may have different capabilities.
         // Therefore, `kvm::Vm::check_extension()` is preferred when querying
         // for most capabilities.
-        [[nodiscard]] auto check_extension(int cap) const -> int;
+        [[nodiscard]] auto check_extension(int cap) const -> int
+        {
+            return m_fd.ioctl(KVM_CHECK_EXTENSION, cap);
+        }
 
         // Sets the number of MMU pages for a virtual machine.
         //
         // See the documentation for KVM_SET_NR_MMU_PAGES.
-        auto set_num_mmu_pages(int n) const -> void;
+        auto set_num_mmu_pages(int n) const -> void
+        {
+            m_fd.ioctl(KVM_SET_NR_MMU_PAGES, n);
+        }
 
         // Returns the number of MMU pages for a virtual machine.
         //
         // See the documentation for KVM_GET_NR_MMU_PAGES.
-        [[nodiscard]] auto num_mmu_pages() const -> std::size_t;
+        [[nodiscard]] auto num_mmu_pages() const -> std::size_t
+        {
+            return static_cast<std::size_t>(m_fd.ioctl(KVM_GET_NR_MMU_PAGES));
+        }
 
         // Creates, modifies, or deletes a guest physical memory slot.
         //
         // See the documentation for KVM_SET_USER_MEMORY_REGION.
-        auto set_memslot(kvm_userspace_memory_region&) const -> void;
+        auto set_memslot(kvm_userspace_memory_region& region) const -> void
+        {
+            m_fd.ioctl(KVM_SET_USER_MEMORY_REGION, &region);
+        }
 
         auto set_memslot(uint32_t slot, uintptr_t guest_addr,
                          uint64_t mem_size, uintptr_t user_addr,
-                         uint32_t flags) const -> void;
+                         uint32_t flags) const -> void
+        {
+            auto mem_region = kvm_userspace_memory_region {
+                slot,
+                flags,
+                guest_addr,
+                mem_size,
+                user_addr,
+            };
+
+            set_memslot(mem_region);
+        }
+
+        // Registers an mmap-backed guest memory region as a memory slot.
+        auto set_memslot(uint32_t slot,
+                         const vmm::memory::detail::GuestMemoryRegion& region,
+                         uint32_t flags=0) const -> void
+        {
+            set_memslot(slot, region.start().data(), region.size(),
+                        reinterpret_cast<uintptr_t>(region.data()), flags);
+        }
 
         // Given a memory slot, returns a vector containing any pages dirtied
         // since the last call to this ioctl.
@@ -144,27 +191,109 @@ class Vm
             m_fd.ioctl(KVM_IOEVENTFD, &ioeventfd);
         }
 
+        // Enables per-vCPU dirty-ring tracking (KVM_CAP_DIRTY_LOG_RING).
+        //
+        // `size` is the ring size in bytes and must be a power of two; it
+        // bounds how many dirtied pages can be outstanding per vCPU between
+        // harvests. Must be called before any vCPU is created. Each vCPU's
+        // ring is then mapped with `Vcpu::dirty_ring()`.
+        auto enable_dirty_ring(uint32_t size) const -> void
+        {
+            auto cap = kvm_enable_cap{};
+            cap.cap = KVM_CAP_DIRTY_LOG_RING;
+            cap.args[0] = size;
+
+            m_fd.ioctl(KVM_ENABLE_CAP, &cap);
+        }
+
+        // Recycles all dirty-ring entries the vCPUs have collected and
+        // flagged for reset. Returns the number of entries recycled.
+        //
+        // See the documentation for KVM_RESET_DIRTY_RINGS.
+        auto reset_dirty_rings() const -> int
+        {
+            return m_fd.ioctl(KVM_RESET_DIRTY_RINGS);
+        }
+
+        // Registers a guest physical address range for MMIO write
+        // coalescing. Writes to the range are recorded in the vCPU's
+        // coalesced MMIO ring instead of causing an exit per write.
+        //
+        // See the documentation for KVM_REGISTER_COALESCED_MMIO.
+        auto register_coalesced_mmio(uint64_t addr, uint32_t size) const -> void
+        {
+            auto zone = kvm_coalesced_mmio_zone{};
+            zone.addr = addr;
+            zone.size = size;
+
+            m_fd.ioctl(KVM_REGISTER_COALESCED_MMIO, &zone);
+        }
+
+        // Unregisters a previously registered MMIO coalescing range.
+        //
+        // See the documentation for KVM_UNREGISTER_COALESCED_MMIO.
+        auto unregister_coalesced_mmio(uint64_t addr, uint32_t size) const -> void
+        {
+            auto zone = kvm_coalesced_mmio_zone{};
+            zone.addr = addr;
+            zone.size = size;
+
+            m_fd.ioctl(KVM_UNREGISTER_COALESCED_MMIO, &zone);
+        }
+
         // Returns the recommended number for max_vcpus.
-        [[nodiscard]] auto num_vcpus() const -> int;
+        [[nodiscard]] auto num_vcpus() const -> int
+        {
+            auto ret = check_extension(KVM_CAP_NR_VCPUS);
+            return ret > 0 ? ret : 4;
+        }
 
         // Returns the maximum possible value for max_vcpus.
-        [[nodiscard]] auto max_vcpus() const -> int;
+        [[nodiscard]] auto max_vcpus() const -> int
+        {
+            auto ret = check_extension(KVM_CAP_MAX_VCPUS);
+            return ret > 0 ? ret : num_vcpus();
+        }
 
         // Returns the maximum number of allowed memory slots for a VM.
-        [[nodiscard]] auto num_memslots() const -> int;
+        [[nodiscard]] auto num_memslots() const -> int
+        {
+            auto ret = check_extension(KVM_CAP_NR_MEMSLOTS);
+            return ret > 0 ? ret : 32;
+        }
 
 #if defined(__i386__) || defined(__x86_64__)  || \
     defined(__arm__)  || defined(__aarch64__)
         // Creates an interrupt controller model in the kernel.
         //
         // See the documentation for KVM_CREATE_IRQCHIP.
-        auto irqchip() const -> void;
+        auto irqchip() const -> void
+        {
+            m_fd.ioctl(KVM_CREATE_IRQCHIP);
+        }
 
         // Registers an event that will, when signaled, trigger the gsi IRQ.
-        auto register_irqfd(vmm::types::EventFd, uint32_t gsi) const -> void;
+        auto register_irqfd(vmm::types::EventFd eventfd, uint32_t gsi) const -> void
+        {
+            auto irqfd = kvm_irqfd {
+                static_cast<uint32_t>(eventfd.fd()),
+                gsi
+            };
+
+            m_fd.ioctl(KVM_IRQFD, &irqfd);
+        }
 
         // Unregisters an event that will, when signaled, trigger the gsi IRQ.
-        auto unregister_irqfd(vmm::types::EventFd, uint32_t gsi) const -> void;
+        auto unregister_irqfd(vmm::types::EventFd eventfd, uint32_t gsi) const -> void
+        {
+            auto irqfd = kvm_irqfd {
+                static_cast<uint32_t>(eventfd.fd()),
+                gsi,
+                KVM_IRQFD_FLAG_DEASSIGN
+            };
+
+            m_fd.ioctl(KVM_IRQFD, &irqfd);
+        }
 
         // Sets the GSI routing table entries, overwriting previous entries.
         //
@@ -181,13 +310,24 @@ class Vm
         // the kernel.
         //
         // See the documentation for KVM_IRQ_LINE.
-        auto set_irq_line(const uint32_t irq, IrqLevel) const -> void;
+        auto set_irq_line(const uint32_t irq, IrqLevel level) const -> void
+        {
+            auto irq_level = kvm_irq_level {
+                { irq },
+                static_cast<uint32_t>(level)
+            };
+
+            m_fd.ioctl(KVM_IRQ_LINE, &irq_level);
+        }
 
         // Directly injects a MSI message. Returns > 0 when the MSI is
         // delivered and 0 when the guest blocked the MSI.
         //
         // See the documentation for KVM_SIGNAL_MSI.
-        auto signal_msi(const kvm_msi&) const -> int;
+        auto signal_msi(const kvm_msi& msi) const -> int
+        {
+            return m_fd.ioctl(KVM_SIGNAL_MSI, &msi);
+        }
 #endif
 
 #if defined(__i386__) || defined(__x86_64__)
@@ -196,49 +336,82 @@ class Vm
         // If a vCPU exists for a VM before this is called, the call will fail.
         //
         // See the documentation for KVM_SET_BOOT_CPU_ID.
-        auto set_bsp(int vcpu_id) const -> void;
+        auto set_bsp(int vcpu_id) const -> void
+        {
+            m_fd.ioctl(KVM_SET_BOOT_CPU_ID, vcpu_id);
+        }
 
         // Reads the state of a kernel interrupt controller into a buffer
         // provided by the caller.
         //
         // See the documentation for KVM_GET_IRQCHIP.
-        auto get_irqchip(kvm_irqchip&) const -> void;
+        auto get_irqchip(kvm_irqchip& irqchip_p) const -> void
+        {
+            m_fd.ioctl(KVM_GET_IRQCHIP, &irqchip_p);
+        }
 
         // Sets the state of a kernel interrupt controller from a buffer
         // provided by the caller.
         //
         // See the documentation for KVM_SET_IRQCHIP.
-        auto set_irqchip(const kvm_irqchip&) const -> void;
+        auto set_irqchip(const kvm_irqchip& irqchip_p) const -> void
+        {
+            m_fd.ioctl(KVM_SET_IRQCHIP, &irqchip_p);
+        }
 
         // Gets the current timestamp of kvmclock as seen by the current guest.
         //
         // See the documentation for KVM_GET_CLOCK.
-        [[nodiscard]] auto get_clock() const -> kvm_clock_data;
+        [[nodiscard]] auto get_clock() const -> kvm_clock_data
+        {
+            auto clock = kvm_clock_data{};
+            m_fd.ioctl(KVM_GET_CLOCK, &clock);
+            return clock;
+        }
 
         // Sets the current timestamp of kvmclock.
         //
         // See the documentation for KVM_SET_CLOCK.
-        auto set_clock(const kvm_clock_data&) const -> void;
+        auto set_clock(const kvm_clock_data& clock) const -> void
+        {
+            m_fd.ioctl(KVM_SET_CLOCK, &clock);
+        }
 
         // Sets the address of a three-page region in a VM's address space.
         //
         // See the documentation for KVM_SET_TSS_ADDR.
-        auto set_tss_address(unsigned long address) const -> void;
+        auto set_tss_address(unsigned long address) const -> void
+        {
+            m_fd.ioctl(KVM_SET_TSS_ADDR, address);
+        }
 
         // Creates an in-kernel device model for the i8254 PIT.
         //
         // See the documentation for KVM_CREATE_PIT2.
-        auto create_pit2(uint32_t flags=0) const -> void;
+        auto create_pit2(uint32_t flags=0) const -> void
+        {
+            auto config = kvm_pit_config{};
+            config.flags = flags;
+            m_fd.ioctl(KVM_CREATE_PIT2, &config);
+        }
 
         // Retrieves the state of the in-kernel PIT model.
         //
         // See the documentation for KVM_GET_PIT2.
-        auto pit2() const -> kvm_pit_state2;
+        auto pit2() const -> kvm_pit_state2
+        {
+            auto state = kvm_pit_state2{};
+            m_fd.ioctl(KVM_GET_PIT2, &state);
+            return state;
+        }
 
         // Sets the state of the in-kernel PIT model.
         //
         // See the documentation for KVM_SET_PIT2.
-        auto set_pit2(const kvm_pit_state2&) const -> void;
+        auto set_pit2(const kvm_pit_state2& state) const -> void
+        {
+            m_fd.ioctl(KVM_SET_PIT2, &state);
+        }
 #endif
 
 #if defined(__arm__) || defined(__aarch64__)
@@ -246,8 +419,127 @@ class Vm
         // on underlying host.
         //
         // See documentation for KVM_ARM_PREFERRED_TARGET.
-        [[nodiscard]] auto preferred_target() const -> kvm_vcpu_init;
+        [[nodiscard]] auto preferred_target() const -> kvm_vcpu_init
+        {
+            auto kvi = kvm_vcpu_init{};
+            m_fd.ioctl(KVM_ARM_PREFERRED_TARGET, &kvi);
+            return kvi;
+        }
 #endif
 };
 
+// Incrementally maintains a VM's GSI routing table against a shadow copy.
+//
+// KVM_SET_GSI_ROUTING can only replace the whole kernel table, so updating
+// one route at a time (MSI-X affinity rebalancing, device hotplug) and
+// resubmitting per change pays an O(table) ioctl payload and kernel-side
+// RCU churn for every entry touched. The manager keeps the authoritative
+// table in userspace, applies add/modify/remove to the shadow, and
+// coalesces any burst of changes into a single submission on `flush()`;
+// untouched bursts and no-op modifications submit nothing.
+//
+// N bounds the table size, as with IrqRouting<N>.
+template<std::size_t N>
+class GsiRoutingManager
+{
+    public:
+        explicit GsiRoutingManager(const Vm& vm) noexcept : m_vm{&vm} {}
+
+        // Adds or replaces the route for `entry.gsi` in the shadow table.
+        // Rewriting an entry with identical contents does not mark the
+        // table dirty.
+        auto set(const kvm_irq_routing_entry& entry) -> void
+        {
+            const auto it = find(entry.gsi);
+
+            if (it != m_entries.end() && it->gsi == entry.gsi) {
+                if (std::memcmp(&*it, &entry, sizeof(entry)) == 0)
+                    return;
+
+                *it = entry;
+            }
+            else {
+                if (m_entries.size() == N)
+                    VMM_THROW(std::overflow_error("Routing table full"));
+
+                m_entries.insert(it, entry);
+            }
+
+            m_dirty = true;
+        }
+
+        // Removes the route for a GSI from the shadow table; returns false
+        // if no such route exists.
+        auto remove(uint32_t gsi) -> bool
+        {
+            const auto it = find(gsi);
+
+            if (it == m_entries.end() || it->gsi != gsi)
+                return false;
+
+            m_entries.erase(it);
+            m_dirty = true;
+
+            return true;
+        }
+
+        // Returns the shadow route for a GSI; nullptr if none exists.
+        [[nodiscard]] auto route(uint32_t gsi) const -> const kvm_irq_routing_entry*
+        {
+            const auto it = find(gsi);
+
+            return it != m_entries.end() && it->gsi == gsi ? &*it : nullptr;
+        }
+
+        [[nodiscard]] auto size() const noexcept -> std::size_t
+        {
+            return m_entries.size();
+        }
+
+        // Checks whether the shadow table has changes the kernel has not
+        // seen yet.
+        [[nodiscard]] auto dirty() const noexcept -> bool
+        {
+            return m_dirty;
+        }
+
+        // Pushes the shadow table to the kernel if anything changed since
+        // the last flush; returns whether an ioctl was issued.
+        auto flush() -> bool
+        {
+            if (!m_dirty)
+                return false;
+
+            auto table = IrqRouting<N>{m_entries.begin(), m_entries.end()};
+            m_vm->gsi_routing(table);
+            m_dirty = false;
+
+            return true;
+        }
+    private:
+        const Vm* m_vm;
+
+        // Sorted by GSI.
+        std::vector<kvm_irq_routing_entry> m_entries{};
+        bool m_dirty = false;
+
+        [[nodiscard]] auto find(uint32_t gsi) const
+            -> std::vector<kvm_irq_routing_entry>::const_iterator
+        {
+            return std::lower_bound(m_entries.begin(), m_entries.end(), gsi,
+                                    [](const kvm_irq_routing_entry& entry,
+                                       uint32_t key) {
+                                        return entry.gsi < key;
+                                    });
+        }
+
+        [[nodiscard]] auto find(uint32_t gsi)
+            -> std::vector<kvm_irq_routing_entry>::iterator
+        {
+            return m_entries.begin() +
+                   (static_cast<const GsiRoutingManager&>(*this).find(gsi) -
+                    m_entries.cbegin());
+        }
+};
+
 }  // namespace vmm::kvm::detail
@@ -25,6 +25,24 @@ namespace vmm::kvm::detail {
 // kvm::System::msr_index_list().
 class System;
 
+// Returns a thread-local pooled memory resource used by FAM structs unless
+// a caller passes its own allocator.
+//
+// The pool is sized so the common shapes (Msrs/MsrList at MAX_IO_MSRS,
+// Cpuids at MAX_CPUID_ENTRIES, typical IrqRouting tables) recycle freed
+// blocks instead of round-tripping through the global heap; vCPU state
+// save/restore constructs these on every checkpoint. Thread-locality keeps
+// the resource lock-free.
+inline auto fam_resource() noexcept -> std::pmr::memory_resource*
+{
+    static thread_local auto pool = std::pmr::unsynchronized_pool_resource{
+        std::pmr::pool_options{64, 1u << 13},
+        std::pmr::new_delete_resource()
+    };
+
+    return &pool;
+}
+
 // Primary FAM struct template
 template<auto SizeMember, auto EntriesMember, std::size_t N>
 class FamStruct;
@@ -52,7 +70,7 @@ class FamStruct<SizeMember, EntriesMember, N>
         static const auto alignment = alignof(Struct);
         static const auto storage_size = sizeof(Struct) + N * sizeof(value_type);
 
-        explicit FamStruct(const allocator_type& alloc={})
+        explicit FamStruct(const allocator_type& alloc=allocator_type{fam_resource()})
             : m_alloc{alloc}, m_ptr{allocate_fam(alloc)}
         {
             std::memset(m_ptr, 0, storage_size);
@@ -76,7 +94,7 @@ class FamStruct<SizeMember, EntriesMember, N>
 
         template <typename InputIt>
         FamStruct(InputIt first, InputIt last)
-            : FamStruct(first, last, std::pmr::new_delete_resource()) {}
+            : FamStruct(first, last, fam_resource()) {}
 
         explicit FamStruct(std::initializer_list<value_type> ilist)
             : FamStruct(ilist.begin(), ilist.end()) {}
@@ -117,7 +135,8 @@ class FamStruct<SizeMember, EntriesMember, N>
             return *this;
         }
 
-        FamStruct(const FamStruct& other, const allocator_type& alloc={})
+        FamStruct(const FamStruct& other,
+                  const allocator_type& alloc=allocator_type{fam_resource()})
             : FamStruct(alloc)
         {
             operator=(other);
@@ -247,6 +266,60 @@ class FamStruct<SizeMember, EntriesMember, N>
         }
 };
 
+// Inline backing storage for InlineFamStruct.
+//
+// Lives in a separate base so the buffer and resource are constructed
+// before the FamStruct base that allocates from them.
+template<std::size_t Size, std::size_t Align>
+struct InlineFamStorage
+{
+    alignas(Align) std::byte m_buffer[Size];
+    std::pmr::monotonic_buffer_resource m_resource{m_buffer, Size,
+                                                   std::pmr::null_memory_resource()};
+};
+
+// A FamStruct whose storage lives inline rather than on the heap.
+//
+// For the small shapes constructed on hot paths (a handful of MSRs per
+// exit, a single CPUID leaf), even a pooled allocation is a pointer chase
+// we can skip: the backing buffer is a member, so the whole struct can sit
+// on the caller's stack. The interface is FamStruct's.
+//
+// Inline structs never share storage, so copying copies and moving copies;
+// both go through the FamStruct element-wise paths.
+template<auto SizeMember, auto EntriesMember, std::size_t N>
+class InlineFamStruct
+    : private InlineFamStorage<FamStruct<SizeMember, EntriesMember, N>::storage_size,
+                               FamStruct<SizeMember, EntriesMember, N>::alignment>,
+      public FamStruct<SizeMember, EntriesMember, N>
+{
+    using Storage = InlineFamStorage<FamStruct<SizeMember, EntriesMember, N>::storage_size,
+                                     FamStruct<SizeMember, EntriesMember, N>::alignment>;
+    using Base = FamStruct<SizeMember, EntriesMember, N>;
+
+    using allocator_type = typename Base::allocator_type;
+    using value_type = typename Base::value_type;
+
+    public:
+        InlineFamStruct() : Base{allocator_type{&this->m_resource}} {}
+
+        template <typename InputIt>
+        InlineFamStruct(InputIt first, InputIt last)
+            : Base{first, last, allocator_type{&this->m_resource}} {}
+
+        InlineFamStruct(std::initializer_list<value_type> ilist)
+            : InlineFamStruct(ilist.begin(), ilist.end()) {}
+
+        InlineFamStruct(const InlineFamStruct& other)
+            : Base{other, allocator_type{&this->m_resource}} {}
+
+        auto operator=(const InlineFamStruct& other) -> InlineFamStruct&
+        {
+            Base::operator=(other);
+            return *this;
+        }
+};
+
 #if defined(__i386__) || defined(__x86_64__)
 // NOTE: Because MsrList's value_type is an integer, it is very easy to confuse
 //       the size_type initializer_list and constructor. That is, one may think
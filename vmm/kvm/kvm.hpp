@@ -18,12 +18,34 @@ using System = vmm::kvm::detail::System;
 using Vm = vmm::kvm::detail::Vm;
 using Vcpu = vmm::kvm::detail::Vcpu;
 using Device = vmm::kvm::detail::Device;
+using DeviceAttrError = vmm::kvm::detail::DeviceAttrError;
 
 using VcpuExit = vmm::kvm::detail::VcpuExit;
+using IoDirection = vmm::kvm::detail::IoDirection;
+using IoExit = vmm::kvm::detail::IoExit;
+using MmioExit = vmm::kvm::detail::MmioExit;
+using CoalescedMmioRing = vmm::kvm::detail::CoalescedMmioRing;
+using DirtyRing = vmm::kvm::detail::DirtyRing;
+
+using vmm::kvm::detail::VCPU_KICK_WAKE;
+using vmm::kvm::detail::VCPU_KICK_PAUSE;
+using vmm::kvm::detail::VCPU_KICK_USER;
+
+#if defined(VMM_VCPU_STATS)
+using VcpuStats = vmm::kvm::detail::VcpuStats;
+using VcpuStatsSnapshot = vmm::kvm::detail::VcpuStatsSnapshot;
+#endif
+
+#if defined(__i386__) || defined(__x86_64__)
+using VcpuState = vmm::kvm::detail::VcpuState;
+using vmm::kvm::detail::save_vcpus;
+using vmm::kvm::detail::restore_vcpus;
+#endif
 
 using IrqLevel = vmm::kvm::detail::IrqLevel;
 
 template<std::size_t N> using IrqRouting = vmm::kvm::detail::IrqRouting<N>;
+template<std::size_t N> using GsiRoutingManager = vmm::kvm::detail::GsiRoutingManager<N>;
 #if defined(__i386__) || defined(__x86_64__)
 template<std::size_t N> using MsrList = vmm::kvm::detail::MsrList<N>;
 template<std::size_t N> using Msrs = vmm::kvm::detail::Msrs<N>;
@@ -0,0 +1,88 @@
+//
+// dirty_bitmap.cpp - Dirty bitmap scanning
+//
+
+#include "vmm/memory/detail/dirty_bitmap.hpp"
+
+namespace vmm::memory::detail {
+
+namespace {
+
+// Index of the first page past the end of a run of set bits starting at
+// `start` in `word`.
+auto run_end(uint64_t word, unsigned start) noexcept -> unsigned
+{
+    const auto shifted = word >> start;
+
+    if (~shifted == 0)
+        return 64;
+
+    return start + static_cast<unsigned>(__builtin_ctzll(~shifted));
+}
+
+}  // namespace
+
+auto scan_dirty_bitmap(const uint64_t* bitmap, std::size_t words,
+                       GuestAddress base, uint64_t page_size,
+                       std::vector<DirtyRange>& ranges) -> std::size_t
+{
+    const auto appended = ranges.size();
+
+    // Current run of dirty pages, as page indices relative to `base`.
+    auto run_start = uint64_t{};
+    auto run_len = uint64_t{};
+
+    auto flush = [&] {
+        if (run_len != 0) {
+            ranges.push_back({base + run_start * page_size,
+                              run_len * page_size});
+            run_len = 0;
+        }
+    };
+
+    for (auto i = std::size_t{}; i < words;) {
+        // Skip clean stretches four words (256 pages) at a time; the
+        // unrolled OR compiles down to wide vector compares.
+        while (i + 4 <= words &&
+               (bitmap[i] | bitmap[i + 1] | bitmap[i + 2] | bitmap[i + 3]) == 0)
+            i += 4;
+
+        if (i >= words)
+            break;
+
+        auto word = bitmap[i];
+
+        while (word != 0) {
+            const auto first = static_cast<unsigned>(__builtin_ctzll(word));
+            const auto last = run_end(word, first);
+            const auto page = static_cast<uint64_t>(i) * 64 + first;
+
+            if (run_len != 0 && page == run_start + run_len) {
+                run_len += last - first;
+            }
+            else {
+                flush();
+                run_start = page;
+                run_len = last - first;
+            }
+
+            word = last >= 64 ? 0 : word & (~uint64_t{} << last);
+        }
+
+        i++;
+    }
+
+    flush();
+
+    return ranges.size() - appended;
+}
+
+auto scan_dirty_bitmap(const std::vector<uint64_t>& bitmap, GuestAddress base,
+                       uint64_t page_size) -> std::vector<DirtyRange>
+{
+    auto ranges = std::vector<DirtyRange>{};
+    scan_dirty_bitmap(bitmap.data(), bitmap.size(), base, page_size, ranges);
+    return ranges;
+}
+
+}  // vmm::memory::detail
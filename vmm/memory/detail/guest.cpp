@@ -1,90 +1,449 @@
+#include <algorithm> // min, upper_bound
+#include <atomic> // atomic
+#include <cstdlib> // aligned_alloc, free
+#include <fstream> // ifstream
+#include <new> // bad_alloc
+#include <sstream> // istringstream
+#include <thread> // thread
+#include <utility> // exchange
+
+#include <fcntl.h> // open, fcntl, O_*, F_ADD_SEALS, F_SEAL_SHRINK
+#include <linux/mempolicy.h> // MPOL_BIND, MPOL_INTERLEAVE, MPOL_MF_*
+#include <sched.h> // cpu_set_t, CPU_ZERO, CPU_SET, sched_setaffinity
+#include <sys/mman.h> // madvise, mmap, munmap, PROT_*, MAP_*, MADV_*, MFD_*
+#include <sys/syscall.h> // SYS_mbind, SYS_memfd_create
+#include <unistd.h> // close, ftruncate, pread, pwrite, syscall, sysconf
+
 #include "vmm/memory/detail/guest.hpp"
 #include "vmm/types/detail/exceptions.hpp"
 
+// Not all libcs expose the hugetlb page-size encoding.
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+#ifndef MAP_HUGETLB
+#define MAP_HUGETLB 0x40000
+#endif
+
+// Kernels before 5.14 lack MADV_POPULATE_WRITE; the touch fallback below
+// covers them.
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23
+#endif
+
 namespace vmm::memory::detail {
 
-auto GuestAddress::data() const noexcept -> size_type
+AlignedBuffer::AlignedBuffer(std::size_t size, std::size_t alignment)
 {
-    return m_addr;
+    // aligned_alloc requires the size to be a multiple of the alignment.
+    m_size = (size + alignment - 1) & ~(alignment - 1);
+    m_data = std::aligned_alloc(alignment, m_size);
+
+    if (m_data == nullptr)
+        VMM_THROW(std::bad_alloc{});
 }
 
-auto GuestAddress::operator&(const size_type mask) const noexcept -> size_type
+AlignedBuffer::~AlignedBuffer()
 {
-    return m_addr & mask;
+    std::free(m_data);
 }
 
-auto GuestAddress::operator|(const size_type mask) const noexcept -> size_type
+AlignedBuffer::AlignedBuffer(AlignedBuffer&& other) noexcept
+    : m_data{std::exchange(other.m_data, nullptr)}, m_size{other.m_size}
 {
-    return m_addr | mask;
 }
 
-auto GuestAddress::operator+(const size_type val) const noexcept -> value_type
+auto AlignedBuffer::operator=(AlignedBuffer&& other) noexcept -> AlignedBuffer&
 {
-    return GuestAddress{m_addr + val};
+    if (&other == this)
+        return *this;
+
+    std::free(m_data);
+    m_data = std::exchange(other.m_data, nullptr);
+    m_size = other.m_size;
+
+    return *this;
 }
 
-auto GuestAddress::operator+(const_reference addr) const noexcept -> value_type
+auto FileOffset::open_file(const char* filename, bool direct) -> int
 {
-    return *this + addr.data();
+    const auto fd = ::open(filename,
+                           direct ? O_RDWR | O_CLOEXEC | O_DIRECT
+                                  : O_RDWR | O_CLOEXEC);
+
+    if (fd < 0)
+        VMM_THROW(std::system_error(errno, std::system_category()));
+
+    return fd;
 }
 
-auto GuestAddress::operator-(const size_type val) const noexcept -> value_type
+auto FileOffset::read(void* buf, std::size_t len, off_t offset) const -> std::size_t
 {
-    return GuestAddress{m_addr - val};
+    const auto ret = ::pread(m_fd, buf, len, m_start + offset);
+
+    if (ret < 0)
+        VMM_THROW(std::system_error(errno, std::system_category()));
+
+    return static_cast<std::size_t>(ret);
 }
 
-auto GuestAddress::operator-(const_reference addr) const noexcept -> value_type
+auto FileOffset::write(const void* buf, std::size_t len, off_t offset) const -> std::size_t
 {
-    return *this - addr.data();
+    const auto ret = ::pwrite(m_fd, buf, len, m_start + offset);
+
+    if (ret < 0)
+        VMM_THROW(std::system_error(errno, std::system_category()));
+
+    return static_cast<std::size_t>(ret);
 }
 
-auto GuestAddress::align(const size_type alignment) noexcept -> reference
+namespace {
+
+// A host-virtual span handed to one prefault worker.
+struct PrefaultSlice
+{
+    unsigned char* base;
+    std::size_t len;
+};
+
+// Populates one slice, falling back to a write-touch of every page where
+// the kernel rejects MADV_POPULATE_WRITE.
+auto populate_slice(const PrefaultSlice& slice) noexcept -> void
+{
+    if (madvise(slice.base, slice.len, MADV_POPULATE_WRITE) == 0)
+        return;
+
+    const auto page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+
+    for (auto off = std::size_t{}; off < slice.len; off += page) {
+        auto* byte = reinterpret_cast<volatile unsigned char*>(
+            slice.base + off);
+
+        // Writing the value back faults the page in without changing it.
+        *byte = *byte;
+    }
+}
+
+// Splits a mapping into page-aligned, roughly per-worker chunks.
+auto slice_mapping(void* host, std::size_t size, std::size_t pieces,
+                   std::vector<PrefaultSlice>& slices) -> void
 {
-    const auto mask = alignment - 1;
-    m_addr = (*this + mask) & ~mask;
+    const auto page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    auto chunk = (size / pieces) & ~(page - 1);
+
+    if (chunk == 0)
+        chunk = size;
+
+    auto* base = static_cast<unsigned char*>(host);
+
+    for (auto off = std::size_t{}; off < size; off += chunk)
+        slices.push_back({base + off, std::min(chunk, size - off)});
+}
+
+auto parallel_populate(const std::vector<PrefaultSlice>& slices,
+                       unsigned workers) -> void
+{
+    if (workers == 0)
+        workers = std::thread::hardware_concurrency();
+
+    if (workers == 0)
+        workers = 1;
+
+    const auto pool_size = std::min<std::size_t>(workers, slices.size());
+
+    if (pool_size <= 1) {
+        for (const auto& slice : slices)
+            populate_slice(slice);
+
+        return;
+    }
+
+    auto next = std::atomic<std::size_t>{0};
+
+    const auto worker = [&] {
+        for (;;) {
+            const auto i = next.fetch_add(1, std::memory_order_relaxed);
+
+            if (i >= slices.size())
+                return;
+
+            populate_slice(slices[i]);
+        }
+    };
+
+    auto pool = std::vector<std::thread>{};
+    pool.reserve(pool_size);
+
+    for (auto i = std::size_t{}; i < pool_size; i++)
+        pool.emplace_back(worker);
+
+    for (auto& thread : pool)
+        thread.join();
+}
+
+}  // namespace
+
+GuestMemoryRegion::GuestMemoryRegion(GuestAddress start, size_type size,
+                                     Backing backing)
+    : m_start{start}, m_size{size}, m_backing{backing}
+{
+    if (size == 0)
+        VMM_THROW(std::invalid_argument("Empty guest memory region"));
+
+    const auto page_size = backing_page_size(backing);
+
+    if ((start & (page_size - 1)) != 0 || size % page_size != 0)
+        VMM_THROW(std::invalid_argument("Unaligned guest memory region"));
+
+    auto flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE;
+
+    switch (backing) {
+        case Backing::HugeTlb2M:
+            flags |= MAP_HUGETLB | (21 << MAP_HUGE_SHIFT);
+            break;
+        case Backing::HugeTlb1G:
+            flags |= MAP_HUGETLB | (30 << MAP_HUGE_SHIFT);
+            break;
+        default:
+            break;
+    }
+
+    m_host = mmap(NULL, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+
+    if (m_host == MAP_FAILED)
+        VMM_THROW(std::system_error(errno, std::system_category()));
+
+    // Best effort: khugepaged collapses the mapping when it can, and hosts
+    // built without THP simply stay on 4k pages.
+    if (backing == Backing::TransparentHuge)
+        madvise(m_host, size, MADV_HUGEPAGE);
+}
+
+auto GuestMemoryRegion::shared(GuestAddress start, size_type size,
+                               const char* name) -> GuestMemoryRegion
+{
+    if (size == 0)
+        VMM_THROW(std::invalid_argument("Empty guest memory region"));
+
+    const auto page_size = backing_page_size(Backing::Default);
+
+    if ((start & (page_size - 1)) != 0 || size % page_size != 0)
+        VMM_THROW(std::invalid_argument("Unaligned guest memory region"));
+
+    const auto fd = static_cast<int>(
+        syscall(SYS_memfd_create, name, MFD_CLOEXEC | MFD_ALLOW_SEALING));
+
+    if (fd < 0)
+        VMM_THROW(std::system_error(errno, std::system_category()));
+
+    if (ftruncate(fd, static_cast<off_t>(size)) < 0 ||
+        fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK) < 0) {
+        const auto error = errno;
+        ::close(fd);
+        VMM_THROW(std::system_error(error, std::system_category()));
+    }
+
+    const auto host = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                           fd, 0);
+
+    if (host == MAP_FAILED) {
+        const auto error = errno;
+        ::close(fd);
+        VMM_THROW(std::system_error(error, std::system_category()));
+    }
+
+    auto region = GuestMemoryRegion{start, size, host};
+    region.m_fd = fd;
+
+    return region;
+}
+
+GuestMemoryRegion::~GuestMemoryRegion()
+{
+    if (m_host)
+        munmap(m_host, m_size);
+
+    if (m_fd >= 0)
+        ::close(m_fd);
+}
+
+GuestMemoryRegion::GuestMemoryRegion(GuestMemoryRegion&& other) noexcept
+    : m_start{other.m_start},
+      m_size{other.m_size},
+      m_host{std::exchange(other.m_host, nullptr)},
+      m_backing{other.m_backing},
+      m_fd{std::exchange(other.m_fd, -1)}
+{
+}
+
+auto GuestMemoryRegion::operator=(GuestMemoryRegion&& other) noexcept -> GuestMemoryRegion&
+{
+    if (&other == this)
+        return *this;
+
+    if (m_host)
+        munmap(m_host, m_size);
+
+    if (m_fd >= 0)
+        ::close(m_fd);
+
+    m_start = other.m_start;
+    m_size = other.m_size;
+    m_host = std::exchange(other.m_host, nullptr);
+    m_backing = other.m_backing;
+    m_fd = std::exchange(other.m_fd, -1);
+
     return *this;
 }
 
-auto MemoryRegionAddress::data() const noexcept -> size_type
+auto GuestMemoryRegion::get_host_address(GuestAddress addr) const noexcept -> void*
+{
+    if (!contains(addr))
+        return nullptr;
+
+    return static_cast<unsigned char*>(m_host) + (addr.data() - m_start.data());
+}
+
+auto GuestMemoryRegion::prefault(unsigned workers) const -> void
+{
+    const auto pieces = workers ? workers : std::thread::hardware_concurrency();
+
+    auto slices = std::vector<PrefaultSlice>{};
+    slice_mapping(m_host, m_size, pieces ? pieces : 1, slices);
+
+    parallel_populate(slices, workers);
+}
+
+auto GuestMemoryRegion::apply_mempolicy(int mode, uint64_t nodemask) const -> void
 {
-    return m_addr;
+    // Without libnuma there is no glibc wrapper for mbind; the raw syscall
+    // keeps the library dependency-free. MPOL_MF_MOVE migrates pages that
+    // already faulted in on the wrong node.
+    if (syscall(SYS_mbind, m_host, m_size, mode, &nodemask,
+                sizeof(nodemask) * 8 + 1,
+                MPOL_MF_STRICT | MPOL_MF_MOVE) < 0)
+        VMM_THROW(std::system_error(errno, std::system_category()));
 }
 
-auto MemoryRegionAddress::operator&(const size_type mask) const noexcept -> size_type
+auto GuestMemoryRegion::bind_to_node(unsigned node) const -> void
 {
-    return m_addr & mask;
+    if (node >= sizeof(uint64_t) * 8)
+        VMM_THROW(std::invalid_argument("NUMA node out of range"));
+
+    apply_mempolicy(MPOL_BIND, uint64_t{1} << node);
+}
+
+auto GuestMemoryRegion::interleave(uint64_t nodemask) const -> void
+{
+    if (nodemask == 0)
+        VMM_THROW(std::invalid_argument("Empty NUMA node mask"));
+
+    apply_mempolicy(MPOL_INTERLEAVE, nodemask);
 }
 
-auto MemoryRegionAddress::operator|(const size_type mask) const noexcept -> size_type
+auto node_cpus(unsigned node) -> std::vector<unsigned>
 {
-    return m_addr | mask;
+    auto file = std::ifstream{"/sys/devices/system/node/node" +
+                              std::to_string(node) + "/cpulist"};
+
+    if (!file)
+        VMM_THROW(std::invalid_argument("No such NUMA node"));
+
+    auto list = std::string{};
+    std::getline(file, list);
+
+    // The sysfs list is comma-separated ranges, e.g. "0-7,16-23".
+    auto stream = std::istringstream{list};
+    auto item = std::string{};
+    auto cpus = std::vector<unsigned>{};
+
+    while (std::getline(stream, item, ',')) {
+        const auto dash = item.find('-');
+        const auto first =
+            static_cast<unsigned>(std::stoul(item.substr(0, dash)));
+        const auto last = dash == std::string::npos
+            ? first
+            : static_cast<unsigned>(std::stoul(item.substr(dash + 1)));
+
+        for (auto cpu = first; cpu <= last; cpu++)
+            cpus.push_back(cpu);
+    }
+
+    return cpus;
 }
 
-auto MemoryRegionAddress::operator+(const size_type val) const noexcept -> value_type
+auto pin_current_thread_to_node(unsigned node) -> void
 {
-    return MemoryRegionAddress{m_addr + val};
+    auto set = cpu_set_t{};
+    CPU_ZERO(&set);
+
+    for (const auto cpu : node_cpus(node))
+        CPU_SET(cpu, &set);
+
+    if (sched_setaffinity(0, sizeof(set), &set) < 0)
+        VMM_THROW(std::system_error(errno, std::system_category()));
 }
 
-auto MemoryRegionAddress::operator+(const_reference addr) const noexcept -> value_type
+auto GuestMemory::prefault(unsigned workers) const -> void
 {
-    return *this + addr.data();
+    const auto pieces = workers ? workers : std::thread::hardware_concurrency();
+
+    auto slices = std::vector<PrefaultSlice>{};
+
+    for (const auto& region : m_regions)
+        slice_mapping(region.data(), region.size(), pieces ? pieces : 1,
+                      slices);
+
+    parallel_populate(slices, workers);
 }
 
-auto MemoryRegionAddress::operator-(const size_type val) const noexcept -> value_type
+auto GuestMemory::insert(GuestMemoryRegion region) -> const GuestMemoryRegion&
 {
-    return MemoryRegionAddress{m_addr - val};
+    const auto start = region.start().data();
+    const auto it = std::upper_bound(m_starts.begin(), m_starts.end(), start);
+    const auto idx = static_cast<std::size_t>(it - m_starts.begin());
+
+    if (idx > 0 && m_regions[idx - 1].last().data() >= start)
+        VMM_THROW(std::invalid_argument("Overlapping guest memory regions"));
+
+    if (idx < m_regions.size() && region.last().data() >= m_starts[idx])
+        VMM_THROW(std::invalid_argument("Overlapping guest memory regions"));
+
+    m_starts.insert(it, start);
+
+    return *m_regions.insert(m_regions.begin() + static_cast<std::ptrdiff_t>(idx),
+                             std::move(region));
 }
 
-auto MemoryRegionAddress::operator-(const_reference addr) const noexcept -> value_type
+auto GuestMemory::find_region(GuestAddress addr) const noexcept -> const GuestMemoryRegion*
 {
-    return *this - addr.data();
+    if (m_starts.empty() || addr.data() < m_starts.front())
+        return nullptr;
+
+    // Branch-free binary search for the last region starting at or below
+    // `addr`; the step below compiles to a conditional move, so the lookup
+    // costs a predictable log2(n) probes over the dense key array no matter
+    // how addresses are distributed.
+    const auto* base = m_starts.data();
+    auto n = m_starts.size();
+
+    while (n > 1) {
+        const auto half = n / 2;
+        base += (base[half] <= addr.data()) ? half : 0;
+        n -= half;
+    }
+
+    const auto& region = m_regions[static_cast<std::size_t>(base - m_starts.data())];
+
+    return region.contains(addr) ? &region : nullptr;
 }
 
-auto MemoryRegionAddress::align(const size_type alignment) noexcept -> reference
+auto GuestMemory::get_host_address(GuestAddress addr) const noexcept -> void*
 {
-    const auto mask = alignment - 1;
-    m_addr = (*this + mask) & ~mask;
-    return *this;
+    const auto region = find_region(addr);
+
+    return region ? region->get_host_address(addr) : nullptr;
 }
 
 }  // vmm::memory::detail
@@ -0,0 +1,136 @@
+//
+// slots.cpp - Concurrent memslot management with generation snapshots
+//
+
+#include <algorithm> // upper_bound
+
+#include "vmm/memory/detail/slots.hpp"
+
+namespace vmm::memory::detail {
+
+auto MemslotView::find_region(GuestAddress addr) const noexcept
+    -> const GuestMemoryRegion*
+{
+    if (m_starts.empty() || addr.data() < m_starts.front())
+        return nullptr;
+
+    // The same branch-free search as GuestMemory::find_region(): the table
+    // is immutable, so no fence or retry loop is needed around it.
+    const auto* base = m_starts.data();
+    auto n = m_starts.size();
+
+    while (n > 1) {
+        const auto half = n / 2;
+        base += (base[half] <= addr.data()) ? half : 0;
+        n -= half;
+    }
+
+    const auto& region = *m_regions[static_cast<std::size_t>(base - m_starts.data())];
+
+    return region.contains(addr) ? &region : nullptr;
+}
+
+auto MemslotView::get_host_address(GuestAddress addr) const noexcept -> void*
+{
+    const auto region = find_region(addr);
+
+    return region ? region->get_host_address(addr) : nullptr;
+}
+
+auto MemslotManager::insert(GuestMemoryRegion region)
+    -> std::shared_ptr<const GuestMemoryRegion>
+{
+    const auto lock = std::lock_guard<std::mutex>{m_write};
+
+    auto next = std::make_shared<MemslotView>(*m_view);
+
+    const auto start = region.start().data();
+    const auto last = region.last().data();
+    const auto it = std::upper_bound(next->m_starts.begin(),
+                                     next->m_starts.end(), start);
+    const auto idx = static_cast<std::size_t>(it - next->m_starts.begin());
+
+    if (idx > 0 && next->m_regions[idx - 1]->last().data() >= start)
+        VMM_THROW(std::invalid_argument("Overlapping guest memory regions"));
+
+    if (idx < next->m_regions.size() && last >= next->m_starts[idx])
+        VMM_THROW(std::invalid_argument("Overlapping guest memory regions"));
+
+    auto stored = std::make_shared<const GuestMemoryRegion>(std::move(region));
+
+    next->m_starts.insert(it, start);
+    next->m_regions.insert(next->m_regions.begin() +
+                               static_cast<std::ptrdiff_t>(idx),
+                           stored);
+
+    publish(std::move(next));
+
+    return stored;
+}
+
+auto MemslotManager::remove(GuestAddress start) -> bool
+{
+    const auto lock = std::lock_guard<std::mutex>{m_write};
+
+    auto next = std::make_shared<MemslotView>(*m_view);
+
+    const auto it = std::lower_bound(next->m_starts.begin(),
+                                     next->m_starts.end(), start.data());
+
+    if (it == next->m_starts.end() || *it != start.data())
+        return false;
+
+    const auto idx = static_cast<std::ptrdiff_t>(it - next->m_starts.begin());
+
+    next->m_starts.erase(it);
+    next->m_regions.erase(next->m_regions.begin() + idx);
+
+    publish(std::move(next));
+
+    return true;
+}
+
+auto MemslotManager::publish(std::shared_ptr<MemslotView> next) -> void
+{
+    const auto epoch = m_epoch.load(std::memory_order_relaxed) + 1;
+    next->m_epoch = epoch;
+
+    // Publish the table before bumping the epoch counter: a reader that
+    // sees the new epoch is guaranteed to get (at least) the matching
+    // table from view(); the displaced table retires when its last
+    // holder drops it.
+    std::atomic_store_explicit(&m_view,
+                               std::shared_ptr<const MemslotView>{std::move(next)},
+                               std::memory_order_release);
+
+    m_epoch.store(epoch, std::memory_order_release);
+}
+
+PinnedRegion::PinnedRegion(const MemslotManager& manager, GuestAddress addr,
+                           uint64_t len)
+    : m_manager{&manager}, m_addr{addr}, m_len{len}
+{
+    if (len == 0)
+        VMM_THROW(std::invalid_argument("Zero-length pinned range"));
+
+    resolve();
+}
+
+auto PinnedRegion::resolve() -> void
+{
+    auto view = m_manager->view();
+    const auto region = view->find_region(m_addr);
+
+    // The whole range has to lie in one region: a straddling translation
+    // would hand out a pointer whose tail maps somewhere else entirely.
+    if (region != nullptr &&
+        region->last().data() - m_addr.data() >= m_len - 1)
+        m_host = region->get_host_address(m_addr);
+    else
+        m_host = nullptr;
+
+    m_epoch = view->epoch();
+    m_view = std::move(view);
+}
+
+}  // vmm::memory::detail
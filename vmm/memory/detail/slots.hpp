@@ -0,0 +1,228 @@
+//
+// slots.hpp - Concurrent memslot management with generation snapshots
+//
+
+#pragma once
+
+#include <atomic> // atomic, atomic_load_explicit, atomic_store_explicit
+#include <cstddef> // size_t
+#include <cstdint> // uint64_t
+#include <memory> // shared_ptr, make_shared
+#include <mutex> // mutex, lock_guard
+#include <stdexcept> // out_of_range, invalid_argument
+#include <vector> // vector
+
+#include "vmm/memory/detail/guest.hpp"
+#include "vmm/types/detail/exceptions.hpp"
+
+namespace vmm::memory::detail {
+
+// An immutable, generation-tagged snapshot of a guest's memslot layout.
+//
+// Translation works exactly like GuestMemory — a branch-free binary search
+// over a dense start-address array — but the table is frozen at creation:
+// a reader holding a view can translate without any synchronization, no
+// matter what the manager publishes after it. Regions are held by
+// shared_ptr, so a region removed from a later generation stays mapped
+// until the last view referencing it is dropped.
+class MemslotView
+{
+    public:
+        MemslotView() = default;
+
+        // Returns the generation this layout was published as.
+        [[nodiscard]] auto epoch() const noexcept -> uint64_t
+        {
+            return m_epoch;
+        }
+
+        [[nodiscard]] auto size() const noexcept -> std::size_t
+        {
+            return m_regions.size();
+        }
+
+        [[nodiscard]] auto empty() const noexcept -> bool
+        {
+            return m_regions.empty();
+        }
+
+        [[nodiscard]] auto region(std::size_t idx) const noexcept -> const GuestMemoryRegion&
+        {
+            return *m_regions[idx];
+        }
+
+        // Returns the region containing a guest physical address; nullptr
+        // if the address is unmapped in this generation.
+        [[nodiscard]] auto find_region(GuestAddress addr) const noexcept
+            -> const GuestMemoryRegion*;
+
+        // Translates a guest physical address to a host virtual address;
+        // nullptr if the address is unmapped in this generation.
+        [[nodiscard]] auto get_host_address(GuestAddress addr) const noexcept -> void*;
+
+        // Reads a T from guest memory at `addr`; throws std::out_of_range
+        // if the address is unmapped or the object straddles a region
+        // boundary.
+        template<typename T>
+        [[nodiscard]] auto read_obj(GuestAddress addr) const -> T
+        {
+            return containing_region(addr)->template read_obj<T>(addr);
+        }
+
+        // Writes a T to guest memory at `addr`; throws std::out_of_range if
+        // the address is unmapped or the object straddles a region boundary.
+        template<typename T>
+        auto write_obj(GuestAddress addr, const T& value) const -> void
+        {
+            containing_region(addr)->write_obj(addr, value);
+        }
+    private:
+        uint64_t m_epoch{};
+
+        // Sorted by start address; m_starts[i] == m_regions[i]->start().
+        std::vector<std::shared_ptr<const GuestMemoryRegion>> m_regions;
+        std::vector<uint64_t> m_starts;
+
+        [[nodiscard]] auto containing_region(GuestAddress addr) const
+            -> const GuestMemoryRegion*
+        {
+            const auto region = find_region(addr);
+
+            if (region == nullptr)
+                VMM_THROW(std::out_of_range("Guest memory access out of bounds"));
+
+            return region;
+        }
+
+        friend class MemslotManager;
+};
+
+// Publishes memslot layouts to concurrent readers, RCU-style.
+//
+// Hotplug and virtio-mem resizing change the layout while vCPU threads
+// are translating; stopping the vCPUs for every slot change turns a
+// hotplug into a guest-visible pause. Instead, readers pay one acquire
+// load on `view()` for a snapshot they can use indefinitely, and nothing
+// on translation itself. Writers (serialized internally) copy the
+// region-pointer table, apply the change, and publish the new generation
+// with one release store; the displaced table — and any region only it
+// references — is retired when its last reader lets go, which is the
+// grace period.
+//
+// `epoch()` is a monotonic generation counter bumped per publication;
+// cached translations can compare it against the epoch of the view they
+// were resolved from to detect staleness with a single load.
+class MemslotManager
+{
+    public:
+        MemslotManager() : m_view{std::make_shared<const MemslotView>()} {}
+
+        MemslotManager(const MemslotManager&) = delete;
+        auto operator=(const MemslotManager&) -> MemslotManager& = delete;
+
+        // Returns the current layout; one acquire load. The view stays
+        // consistent (and its regions mapped) for as long as the caller
+        // holds it, regardless of later updates.
+        [[nodiscard]] auto view() const -> std::shared_ptr<const MemslotView>
+        {
+            return std::atomic_load_explicit(&m_view,
+                                             std::memory_order_acquire);
+        }
+
+        // Returns the generation of the most recently published layout.
+        [[nodiscard]] auto epoch() const noexcept -> uint64_t
+        {
+            return m_epoch.load(std::memory_order_acquire);
+        }
+
+        // Adds a region and publishes the next generation. Throws if the
+        // region overlaps an existing one. Returns the stored region; pass
+        // it to `Vm::set_memslot()` to mirror the change into KVM.
+        auto insert(GuestMemoryRegion region)
+            -> std::shared_ptr<const GuestMemoryRegion>;
+
+        // Removes the region starting at `start` and publishes the next
+        // generation; returns false if no region starts there. The region's
+        // mapping survives until every view holding it is dropped, so
+        // in-flight translations on other threads stay valid.
+        auto remove(GuestAddress start) -> bool;
+    private:
+        // Current layout; accessed with std::atomic_load/store (the same
+        // idiom as System::features()).
+        std::shared_ptr<const MemslotView> m_view;
+
+        // Mirrors m_view->epoch() for cheap staleness checks.
+        std::atomic<uint64_t> m_epoch{};
+
+        // Serializes writers; readers never take it.
+        std::mutex m_write;
+
+        // Publishes `next` as the new generation (m_write must be held).
+        auto publish(std::shared_ptr<MemslotView> next) -> void;
+};
+
+// A cached guest-to-host translation, revalidated by generation.
+//
+// Structures at fixed guest addresses — virtio descriptor tables, avail
+// and used rings, device config pages — are accessed on every
+// notification, and re-running the region lookup each time wastes the
+// fact that the answer almost never changes. A handle resolves
+// (address, length) against the manager once; `get()` then costs a single
+// epoch compare before handing back the cached host pointer, and only a
+// memslot change re-runs the lookup. The handle keeps the view it
+// resolved from, so the cached pointer stays mapped even while the
+// layout moves underneath it.
+class PinnedRegion
+{
+    public:
+        PinnedRegion() = default;
+
+        // Resolves the range immediately; throws std::invalid_argument on a
+        // zero-length range. A range that is unmapped (or straddles a
+        // region boundary) yields a null pointer that re-resolves when the
+        // layout next changes.
+        PinnedRegion(const MemslotManager& manager, GuestAddress addr,
+                     uint64_t len);
+
+        // Returns the host pointer for the pinned range, re-resolving only
+        // if the memslot generation moved since the last call; nullptr
+        // while the range is unmapped. This is the per-notification path:
+        // one acquire load and a compare in the common case.
+        [[nodiscard]] auto get() -> void*
+        {
+            if (m_manager == nullptr)
+                return nullptr;
+
+            if (m_manager->epoch() != m_epoch)
+                resolve();
+
+            return m_host;
+        }
+
+        // Returns the guest physical address of the pinned range.
+        [[nodiscard]] auto addr() const noexcept -> GuestAddress
+        {
+            return m_addr;
+        }
+
+        // Returns the pinned range's length, in bytes.
+        [[nodiscard]] auto size() const noexcept -> uint64_t
+        {
+            return m_len;
+        }
+    private:
+        const MemslotManager* m_manager{};
+        GuestAddress m_addr{};
+        uint64_t m_len{};
+
+        // The generation the cached translation was resolved from, and the
+        // view that keeps its region mapped.
+        uint64_t m_epoch{};
+        std::shared_ptr<const MemslotView> m_view{};
+        void* m_host{};
+
+        // Re-runs the lookup against the current generation.
+        auto resolve() -> void;
+};
+
+}  // vmm::memory::detail
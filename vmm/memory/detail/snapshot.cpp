@@ -0,0 +1,76 @@
+//
+// snapshot.cpp - Copy-on-write guest memory snapshots
+//
+
+#include <fcntl.h> // fcntl, F_ADD_SEALS, F_SEAL_*
+#include <sys/mman.h> // memfd_create, mmap, MAP_*, PROT_*
+#include <unistd.h> // ftruncate, pwrite
+
+#include "vmm/memory/detail/snapshot.hpp"
+#include "vmm/types/detail/exceptions.hpp"
+
+namespace vmm::memory::detail {
+
+MemorySnapshot::MemorySnapshot(const GuestMemory& memory)
+{
+    m_fd = ::memfd_create("libvmm-snapshot", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+
+    if (m_fd < 0)
+        VMM_THROW(std::system_error(errno, std::system_category()));
+
+    m_slots.reserve(memory.size());
+
+    for (auto i = std::size_t{}; i < memory.size(); i++) {
+        const auto& region = memory.region(i);
+
+        m_slots.push_back({region.start(), region.size(),
+                           static_cast<off_t>(m_size)});
+        m_size += region.size();
+    }
+
+    if (::ftruncate(m_fd, static_cast<off_t>(m_size)) < 0)
+        VMM_THROW(std::system_error(errno, std::system_category()));
+
+    for (std::size_t i = 0; i < m_slots.size(); i++) {
+        const auto& slot = m_slots[i];
+        const auto* src = static_cast<const char*>(memory.region(i).data());
+        auto remaining = slot.size;
+        auto offset = slot.offset;
+
+        while (remaining > 0) {
+            const auto ret = ::pwrite(m_fd, src, remaining, offset);
+
+            if (ret < 0)
+                VMM_THROW(std::system_error(errno, std::system_category()));
+
+            src += ret;
+            offset += ret;
+            remaining -= static_cast<uint64_t>(ret);
+        }
+    }
+
+    // Freeze the template: nothing can resize or rewrite the snapshot from
+    // here on, so every fork sees identical contents.
+    if (::fcntl(m_fd, F_ADD_SEALS,
+                F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) < 0)
+        VMM_THROW(std::system_error(errno, std::system_category()));
+}
+
+auto MemorySnapshot::fork() const -> GuestMemory
+{
+    auto memory = GuestMemory{};
+
+    for (const auto& slot : m_slots) {
+        auto* host = mmap(NULL, slot.size, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_NORESERVE, m_fd, slot.offset);
+
+        if (host == MAP_FAILED)
+            VMM_THROW(std::system_error(errno, std::system_category()));
+
+        memory.insert(GuestMemoryRegion{slot.start, slot.size, host});
+    }
+
+    return memory;
+}
+
+}  // namespace vmm::memory::detail
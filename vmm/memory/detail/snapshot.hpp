@@ -0,0 +1,58 @@
+//
+// snapshot.hpp - Copy-on-write guest memory snapshots
+//
+
+#pragma once
+
+#include <cstdint> // uint64_t
+#include <vector> // vector
+
+#include <sys/types.h> // off_t
+
+#include "vmm/memory/detail/guest.hpp"
+#include "vmm/types/file_descriptor.hpp"
+
+namespace vmm::memory::detail {
+
+// A frozen copy of a guest's memory, forkable into copy-on-write children.
+//
+// The snapshot copies every region of the template guest into one sealed
+// memfd. `fork()` then maps the memfd MAP_PRIVATE into a fresh GuestMemory:
+// the child starts with near-zero memory copied, shares the snapshot's page
+// cache pages with its siblings for reads, and faults in private pages only
+// on write. Cloning hundreds of near-identical sandbox guests from one
+// booted template this way costs milliseconds per child instead of a
+// multi-GiB copy, and the fleet's footprint collapses onto the shared
+// pages.
+class MemorySnapshot : public vmm::types::FileDescriptor
+{
+    public:
+        // Freezes the contents of `memory`. The template VM should be
+        // paused while the snapshot is taken; the snapshot is sealed
+        // against any later modification.
+        explicit MemorySnapshot(const GuestMemory& memory);
+
+        // Creates a copy-on-write child address space with the same region
+        // layout and contents as the snapshot.
+        [[nodiscard]] auto fork() const -> GuestMemory;
+
+        // Returns the total number of snapshotted bytes.
+        [[nodiscard]] auto size() const noexcept -> uint64_t
+        {
+            return m_size;
+        }
+    private:
+        // One snapshotted region: its guest layout plus where its bytes
+        // live in the memfd.
+        struct Slot
+        {
+            GuestAddress start;
+            uint64_t size;
+            off_t offset;
+        };
+
+        std::vector<Slot> m_slots{};
+        uint64_t m_size{};
+};
+
+}  // namespace vmm::memory::detail
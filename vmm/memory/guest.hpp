@@ -1,7 +1,28 @@
 #pragma once
 
-//#include "vmm/memory/detail/guest.hpp"
+#include "vmm/memory/detail/guest.hpp"
+#include "vmm/memory/detail/slots.hpp"
+#include "vmm/memory/detail/snapshot.hpp"
 
-//namespace vmm::memory {
+namespace vmm::memory {
 
-//}  // vmm::memory
+using GuestAddress = vmm::memory::detail::GuestAddress;
+using MemoryRegionAddress = vmm::memory::detail::MemoryRegionAddress;
+
+using AlignedBuffer = vmm::memory::detail::AlignedBuffer;
+using FileOffset = vmm::memory::detail::FileOffset;
+
+using Backing = vmm::memory::detail::Backing;
+using vmm::memory::detail::backing_page_size;
+using vmm::memory::detail::is_byte_valued_v;
+using vmm::memory::detail::node_cpus;
+using vmm::memory::detail::pin_current_thread_to_node;
+
+using GuestMemoryRegion = vmm::memory::detail::GuestMemoryRegion;
+using GuestMemory = vmm::memory::detail::GuestMemory;
+using MemslotView = vmm::memory::detail::MemslotView;
+using MemslotManager = vmm::memory::detail::MemslotManager;
+using PinnedRegion = vmm::memory::detail::PinnedRegion;
+using MemorySnapshot = vmm::memory::detail::MemorySnapshot;
+
+}  // vmm::memory
@@ -5,7 +5,10 @@
 #pragma once
 
 #include "vmm/memory/detail/address.hpp"
+#include "vmm/memory/detail/dirty_bitmap.hpp"
 #include "vmm/memory/detail/guest.hpp"
+#include "vmm/memory/detail/slots.hpp"
+#include "vmm/memory/detail/snapshot.hpp"
 
 namespace vmm::memory {
 
@@ -16,9 +19,28 @@ template<typename T, typename S>
 using Address = vmm::memory::detail::Address<T, S>;
 
 using GuestAddress = vmm::memory::detail::GuestAddress;
-//using MemoryRegionAddress = vmm::memory::detail::MemoryRegionAddress;
-//using MemoryRegion = vmm::memory::detail::MemoryRegion;
+using MemoryRegionAddress = vmm::memory::detail::MemoryRegionAddress;
 
-//using FileOffset = vmm::memory::detail::FileOffset;
+using AlignedBuffer = vmm::memory::detail::AlignedBuffer;
+using FileOffset = vmm::memory::detail::FileOffset;
+
+using vmm::memory::detail::is_byte_valued_v;
+using vmm::memory::detail::node_cpus;
+using vmm::memory::detail::pin_current_thread_to_node;
+
+using Backing = vmm::memory::detail::Backing;
+using vmm::memory::detail::backing_page_size;
+
+using GuestMemoryRegion = vmm::memory::detail::GuestMemoryRegion;
+using GuestMemory = vmm::memory::detail::GuestMemory;
+
+using MemslotView = vmm::memory::detail::MemslotView;
+using MemslotManager = vmm::memory::detail::MemslotManager;
+using PinnedRegion = vmm::memory::detail::PinnedRegion;
+
+using MemorySnapshot = vmm::memory::detail::MemorySnapshot;
+
+using DirtyRange = vmm::memory::detail::DirtyRange;
+using vmm::memory::detail::scan_dirty_bitmap;
 
 }  // vmm::memory
@@ -7,6 +7,7 @@
 #include <cstdint> // uint64_t
 #include <system_error> // error_code, system_category, system_error
 #include <sys/eventfd.h> // eventfd
+#include <unistd.h> // read, write
 
 #include "vmm/types/file_descriptor.hpp"
 
@@ -24,10 +25,46 @@ class EventFd : public FileDescriptor
         EventFd(int flags=0);
 
         // Increments the value of the 8-byte counter in the eventfd object by `value`.
-        auto write(uint64_t value) const -> void;
+        auto write(uint64_t value) const -> void
+        {
+            auto ret = ::write(m_fd, &value, sizeof(uint64_t));
+
+            if (ret < 0)
+                VMM_THROW(std::system_error(errno, std::system_category()));
+        }
 
         // Returns the value of the 8-byte counter in the eventfd object.
-        [[nodiscard]] auto read() const -> uint64_t;
+        [[nodiscard]] auto read() const -> uint64_t
+        {
+            auto buf = uint64_t{};
+            auto ret = ::read(m_fd, &buf, sizeof(uint64_t));
+
+            if (ret < 0)
+                VMM_THROW(std::system_error(errno, std::system_category()));
+
+            return buf;
+        }
+
+        // Non-throwing counterpart of `write()` for hot paths; returns the
+        // error instead (e.g. EAGAIN on a full EFD_NONBLOCK counter).
+        auto try_write(uint64_t value) const noexcept -> std::error_code
+        {
+            if (::write(m_fd, &value, sizeof(uint64_t)) < 0)
+                return std::error_code{errno, std::system_category()};
+
+            return std::error_code{};
+        }
+
+        // Non-throwing counterpart of `read()` for hot paths; on success the
+        // counter is stored in `value` (e.g. EAGAIN means an empty
+        // EFD_NONBLOCK counter).
+        auto try_read(uint64_t& value) const noexcept -> std::error_code
+        {
+            if (::read(m_fd, &value, sizeof(uint64_t)) < 0)
+                return std::error_code{errno, std::system_category()};
+
+            return std::error_code{};
+        }
 };
 
 }  // namespace vmm::types
@@ -0,0 +1,85 @@
+//
+// event_loop.cpp - epoll-based event multiplexer
+//
+
+#include "vmm/types/event_loop.hpp"
+
+namespace vmm::types {
+
+EventLoop::EventLoop()
+{
+    m_fd = ::epoll_create1(EPOLL_CLOEXEC);
+
+    if (m_fd < 0)
+        VMM_THROW(std::system_error(errno, std::system_category()));
+}
+
+auto EventLoop::add(const EventFd& eventfd, Callback callback) -> void
+{
+    // Copy-constructing an EventFd dup()s it, so the loop owns its own fd.
+    auto handler = Handler{eventfd, std::move(callback), eventfd.fd()};
+    const auto fd = handler.eventfd.fd();
+
+    auto event = epoll_event{};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+
+    if (::epoll_ctl(m_fd, EPOLL_CTL_ADD, fd, &event) < 0)
+        VMM_THROW(std::system_error(errno, std::system_category()));
+
+    m_handlers.emplace(fd, std::move(handler));
+}
+
+auto EventLoop::remove(const EventFd& eventfd) -> void
+{
+    for (auto it = m_handlers.begin(); it != m_handlers.end(); ++it) {
+        if (it->second.source != eventfd.fd())
+            continue;
+
+        if (::epoll_ctl(m_fd, EPOLL_CTL_DEL, it->first, nullptr) < 0)
+            VMM_THROW(std::system_error(errno, std::system_category()));
+
+        m_handlers.erase(it);
+        return;
+    }
+
+    VMM_THROW(std::system_error(ENOENT, std::system_category()));
+}
+
+auto EventLoop::dispatch(int timeout_ms) -> std::size_t
+{
+    epoll_event events[64];
+
+    const auto ready = ::epoll_wait(m_fd, events, 64, timeout_ms);
+
+    if (ready < 0) {
+        if (errno == EINTR)
+            return 0;
+
+        VMM_THROW(std::system_error(errno, std::system_category()));
+    }
+
+    auto dispatched = std::size_t{};
+
+    for (auto i = 0; i < ready; i++) {
+        const auto handler = m_handlers.find(events[i].data.fd);
+
+        if (handler == m_handlers.end())
+            continue;
+
+        // Reading an eventfd consumes the whole counter, so one read drains
+        // the fd however many times it was signaled. A concurrent drain may
+        // have emptied an EFD_NONBLOCK counter already; skip it then.
+        auto value = uint64_t{};
+
+        if (handler->second.eventfd.try_read(value))
+            continue;
+
+        handler->second.callback(handler->second.eventfd, value);
+        dispatched++;
+    }
+
+    return dispatched;
+}
+
+}  // namespace vmm::types
@@ -0,0 +1,66 @@
+//
+// event_loop.hpp - epoll-based event multiplexer
+//
+
+#pragma once
+
+#include <cstddef> // size_t
+#include <cstdint> // uint64_t
+#include <functional> // function
+#include <unordered_map> // unordered_map
+#include <sys/epoll.h> // epoll_*
+
+#include "vmm/types/event.hpp"
+#include "vmm/types/file_descriptor.hpp"
+
+namespace vmm::types {
+
+// An epoll-based multiplexer over EventFds.
+//
+// One thread can service many eventfds (e.g. one ioeventfd per virtqueue)
+// with a single epoll_wait() syscall per wakeup: every fd that became ready
+// is drained and dispatched in one batch before the loop sleeps again.
+// Eventfds registered with EFD_NONBLOCK are drained without ever blocking
+// the dispatching thread.
+class EventLoop : public FileDescriptor
+{
+    public:
+        // Invoked with the drained eventfd and its counter value.
+        using Callback = std::function<void(EventFd&, uint64_t)>;
+
+        EventLoop();
+
+        // Registers an eventfd; `callback` runs on the dispatching thread
+        // whenever the eventfd is signaled. The loop keeps its own duplicate
+        // of the eventfd, so the caller's copy may outlive or predecease it.
+        auto add(const EventFd& eventfd, Callback callback) -> void;
+
+        // Unregisters a previously added eventfd.
+        auto remove(const EventFd& eventfd) -> void;
+
+        // Returns the number of registered eventfds.
+        [[nodiscard]] auto size() const noexcept -> std::size_t
+        {
+            return m_handlers.size();
+        }
+
+        // Waits for readiness with a single epoll_wait() call, drains every
+        // ready eventfd, and invokes its callback. `timeout_ms` of -1 blocks
+        // indefinitely; 0 polls. Returns the number of callbacks dispatched.
+        auto dispatch(int timeout_ms=-1) -> std::size_t;
+    private:
+        struct Handler
+        {
+            EventFd eventfd;
+            Callback callback;
+
+            // The fd number the caller registered with, kept so remove()
+            // can match the caller's eventfd against the loop's duplicate.
+            int source;
+        };
+
+        // Keyed by the loop-owned duplicate's fd number (what epoll reports).
+        std::unordered_map<int, Handler> m_handlers;
+};
+
+}  // namespace vmm::types
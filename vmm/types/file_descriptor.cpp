@@ -2,6 +2,8 @@
 // file_descriptor.cpp - File descriptor
 //
 
+#include <utility> // exchange
+
 #include <unistd.h> // close, dup
 
 #include "vmm/types/file_descriptor.hpp"
@@ -35,6 +37,27 @@ auto FileDescriptor::operator=(const FileDescriptor& other) -> FileDescriptor&
     return *this;
 }
 
+// A moved-from descriptor is marked closed so its destructor doesn't close
+// the fd out from under the new owner.
+FileDescriptor::FileDescriptor(FileDescriptor&& other) noexcept
+    : m_fd{other.m_fd}, m_closed{std::exchange(other.m_closed, true)}
+{
+}
+
+auto FileDescriptor::operator=(FileDescriptor&& other) noexcept -> FileDescriptor&
+{
+    if (&other == this)
+        return *this;
+
+    if (!m_closed)
+        ::close(m_fd);
+
+    m_fd = other.m_fd;
+    m_closed = std::exchange(other.m_closed, true);
+
+    return *this;
+}
+
 auto FileDescriptor::close() -> void
 {
     if (::close(m_fd) < 0)
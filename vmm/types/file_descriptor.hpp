@@ -12,6 +12,41 @@
 
 namespace vmm::types {
 
+// The result of a non-throwing ioctl: either the call's raw return value or
+// the `std::error_code` describing why it failed.
+//
+// Hot loops (vCPU runs, eventfd polls) check and branch on the result; no
+// exception machinery is kept live around the call site, and an EINTR is an
+// ordinary branch rather than a throw/catch cycle.
+class IoctlResult
+{
+    public:
+        IoctlResult(int value) noexcept : m_value{value} {}
+
+        IoctlResult(std::error_code error) noexcept : m_error{error} {}
+
+        // Checks whether the ioctl succeeded.
+        [[nodiscard]] explicit operator bool() const noexcept
+        {
+            return !m_error;
+        }
+
+        // Returns the ioctl's return value (only meaningful on success).
+        [[nodiscard]] auto value() const noexcept -> int
+        {
+            return m_value;
+        }
+
+        // Returns the failure reason (default-constructed on success).
+        [[nodiscard]] auto error() const noexcept -> std::error_code
+        {
+            return m_error;
+        }
+    private:
+        int m_value{};
+        std::error_code m_error{};
+};
+
 class FileDescriptor
 {
     public:
@@ -20,9 +55,9 @@ class FileDescriptor
         ~FileDescriptor() noexcept;
 
         FileDescriptor(const FileDescriptor& other);
-        FileDescriptor(FileDescriptor&& other) = default;
+        FileDescriptor(FileDescriptor&& other) noexcept;
         auto operator=(const FileDescriptor& other) -> FileDescriptor&;
-        auto operator=(FileDescriptor&& other) -> FileDescriptor& = default;
+        auto operator=(FileDescriptor&& other) noexcept -> FileDescriptor&;
 
         // Closes a file descriptor.
         auto close() -> void;
@@ -39,6 +74,20 @@ class FileDescriptor
             return ret;
         }
 
+        // Runs an ioctl without throwing, returning the error code on
+        // failure. Intended for hot paths (e.g. KVM_RUN); setup code should
+        // keep using the throwing `ioctl()`.
+        template<typename T=int>
+        auto try_ioctl(long unsigned req, T arg=T{}) const noexcept -> IoctlResult
+        {
+            const auto ret = ::ioctl(m_fd, req, arg);
+
+            if (ret < 0)
+                return IoctlResult{std::error_code{errno, std::system_category()}};
+
+            return IoctlResult{ret};
+        }
+
         auto fd() const noexcept -> int
         {
             return m_fd;
@@ -0,0 +1,139 @@
+//
+// timer.hpp - Timer file descriptor and deadline timer wheel
+//
+
+#pragma once
+
+#include <chrono> // nanoseconds, steady_clock
+#include <cstddef> // size_t
+#include <cstdint> // uint64_t
+#include <functional> // function
+#include <list> // list
+#include <unordered_map> // unordered_map
+#include <utility> // pair
+#include <vector> // vector
+
+#include <sys/timerfd.h> // timerfd_*, TFD_*
+
+#include "vmm/types/file_descriptor.hpp"
+
+namespace vmm::types {
+
+// A timer file descriptor on CLOCK_MONOTONIC.
+class TimerFd : public FileDescriptor
+{
+    public:
+        explicit TimerFd(int flags=0);
+
+        // Arms the timer to fire once, `delay` from now; re-arming replaces
+        // the previous deadline. A non-positive delay is clamped to the
+        // minimum, so the timer still fires (an all-zero timerfd spec would
+        // disarm instead).
+        auto arm(std::chrono::nanoseconds delay) const -> void;
+
+        // Arms the timer to fire every `interval`.
+        auto arm_periodic(std::chrono::nanoseconds interval) const -> void;
+
+        auto disarm() const -> void;
+
+        // Returns the number of expirations since the last read, blocking
+        // until at least one occurs (unless created with TFD_NONBLOCK).
+        [[nodiscard]] auto read() const -> uint64_t;
+
+        // Non-throwing counterpart of `read()` for hot paths; on success
+        // the expiration count is stored in `expirations` (EAGAIN means no
+        // expiration has occurred on a TFD_NONBLOCK timer).
+        auto try_read(uint64_t& expirations) const noexcept -> std::error_code;
+};
+
+// A hashed wheel multiplexing many software deadlines onto one TimerFd.
+//
+// One kernel timer per emulated timer does not scale: per-queue TX
+// coalescing timers re-arm on nearly every packet, and each re-arm is a
+// syscall. The wheel keeps deadlines in user space — arm and cancel are
+// O(1) hash plus list operations — and touches the kernel timer only when
+// the earliest deadline moves. Register `timer()` with the EventLoop and
+// call `expire()` from its callback; every deadline that has passed fires
+// in that one batch.
+//
+// Deadlines round up to the wheel's tick, so a timer fires at most one
+// tick late; distant deadlines alias onto near slots and cost at worst one
+// spurious wakeup per wheel revolution.
+class TimerWheel
+{
+    public:
+        using Callback = std::function<void()>;
+        using TimerId = uint64_t;
+
+        // `tick` is the wheel's resolution; `slots` trades memory against
+        // spurious wakeups for deadlines beyond one revolution
+        // (tick * slots).
+        explicit TimerWheel(
+            std::chrono::nanoseconds tick=std::chrono::milliseconds{1},
+            std::size_t slots=256);
+
+        // Arms a software timer to fire `delay` from now. O(1); the kernel
+        // timer is re-armed only if this becomes the earliest deadline.
+        // Returns a handle for cancel().
+        auto arm(std::chrono::nanoseconds delay, Callback callback) -> TimerId;
+
+        // Cancels a pending timer. O(1); ids that already fired or were
+        // cancelled are ignored.
+        auto cancel(TimerId id) noexcept -> void;
+
+        // Returns the number of pending timers.
+        [[nodiscard]] auto size() const noexcept -> std::size_t
+        {
+            return m_handles.size();
+        }
+
+        // The fd to wait on (nonblocking); when it becomes readable, call
+        // expire().
+        [[nodiscard]] auto timer() const noexcept -> const TimerFd&
+        {
+            return m_timer;
+        }
+
+        // Fires every timer whose deadline has passed, in one batch, and
+        // re-arms the kernel timer for the next pending deadline (or
+        // disarms it when the wheel empties). Returns the number fired.
+        auto expire() -> std::size_t;
+    private:
+        struct Timer
+        {
+            TimerId id;
+
+            // Absolute deadline, in ticks since the clock epoch.
+            uint64_t deadline;
+
+            Callback callback;
+        };
+
+        using Slot = std::list<Timer>;
+
+        TimerFd m_timer{TFD_NONBLOCK | TFD_CLOEXEC};
+        std::chrono::nanoseconds m_tick;
+        std::vector<Slot> m_slots;
+
+        // Timer id -> (slot index, entry) for O(1) cancellation.
+        std::unordered_map<TimerId,
+                           std::pair<std::size_t, Slot::iterator>> m_handles;
+
+        TimerId m_next_id = 1;
+
+        // The next tick expire() will examine (free-running).
+        uint64_t m_cursor;
+
+        // The tick the kernel timer is armed for; 0 when disarmed.
+        uint64_t m_armed{};
+
+        [[nodiscard]] auto now_tick() const noexcept -> uint64_t;
+
+        // Arms the kernel timer for the absolute tick `tick`.
+        auto arm_at(uint64_t tick) -> void;
+
+        // Re-arms the kernel timer for the earliest candidate tick.
+        auto rearm() -> void;
+};
+
+}  // namespace vmm::types
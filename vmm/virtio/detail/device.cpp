@@ -0,0 +1,65 @@
+//
+// device.cpp - Virtio device
+//
+
+#include <stdexcept> // invalid_argument
+
+#include "vmm/virtio/detail/device.hpp"
+#include "vmm/types/detail/exceptions.hpp"
+
+namespace vmm::virtio::detail {
+
+VirtDevice::VirtDevice(uint32_t device_type, uint64_t features)
+    : m_features{features}, m_device_type{device_type}
+{
+}
+
+auto VirtDevice::device_type() const noexcept -> uint32_t
+{
+    return m_device_type;
+}
+
+auto VirtDevice::features() const noexcept -> uint64_t
+{
+    return m_features;
+}
+
+auto VirtDevice::ack_features(uint64_t features) -> void
+{
+    if (features & ~m_features)
+        VMM_THROW(std::invalid_argument("Driver acked unoffered features"));
+
+    m_driver_features = features;
+}
+
+auto VirtDevice::driver_features() const noexcept -> uint64_t
+{
+    return m_driver_features;
+}
+
+auto VirtDevice::event_idx() const noexcept -> bool
+{
+    return (m_driver_features & VIRTIO_F_EVENT_IDX) != 0;
+}
+
+auto VirtDevice::num_queues() const noexcept -> std::size_t
+{
+    return m_queues.size();
+}
+
+auto VirtDevice::queue(std::size_t idx) noexcept -> BoundQueue&
+{
+    return m_queues[idx];
+}
+
+auto VirtDevice::notify(std::size_t idx) -> void
+{
+    auto& bound = m_queues[idx];
+
+    bound.queue.publish_used();
+
+    if (bound.queue.needs_notification())
+        bound.call.write(1);
+}
+
+}  // namespace vmm::virtio::detail
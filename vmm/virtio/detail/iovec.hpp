@@ -0,0 +1,96 @@
+//
+// iovec.hpp - Descriptor chain to iovec translation
+//
+
+#pragma once
+
+#include <algorithm> // min
+#include <cstddef> // size_t
+#include <cstdint> // uint*_t
+#include <sys/uio.h> // iovec
+
+#include "vmm/memory/detail/guest.hpp"
+#include "vmm/virtio/detail/queue.hpp"
+
+namespace vmm::virtio::detail {
+
+// The result of translating a descriptor chain into host iovecs.
+//
+// Well-formed chains place every device-readable descriptor before the
+// device-writable ones, so the filled array is `readable` read segments
+// followed by `count - readable` write segments: `iov` feeds a pwritev2()
+// and `iov + readable` a preadv2() with no copying in between.
+struct ChainIovecs
+{
+    // Segments written to the caller's array.
+    std::size_t count;
+
+    // Leading segments the device may read (descriptors without the
+    // `Write` flag).
+    std::size_t readable;
+
+    // False if the chain touched unmapped guest memory, interleaved
+    // readable and writable descriptors, or overflowed the array; the
+    // chain must then be failed rather than serviced.
+    bool ok;
+};
+
+// Maps a descriptor chain through guest memory into a caller-provided
+// iovec array of `capacity` entries.
+//
+// Buffers are referenced in place — no bounce buffer, no heap — so the
+// array can be handed straight to preadv2()/pwritev2()/sendmsg() for one
+// syscall per chain instead of one per descriptor. Descriptors whose
+// buffers cross a region boundary are split across as many iovecs as they
+// span. Works with both DescriptorChain and PackedDescriptorChain.
+template<typename Chain>
+auto chain_to_iovecs(const Chain& chain,
+                     const vmm::memory::detail::GuestMemory& memory,
+                     iovec* iov, std::size_t capacity) noexcept -> ChainIovecs
+{
+    auto result = ChainIovecs{};
+    auto seen_writable = false;
+
+    for (const auto& desc : chain) {
+        const auto writable = desc.is_write_only();
+
+        // The spec requires readable descriptors to precede writable ones.
+        if (!writable && seen_writable)
+            return result;
+
+        seen_writable |= writable;
+
+        auto addr = desc.addr;
+        auto remaining = static_cast<uint64_t>(desc.len);
+
+        while (remaining > 0) {
+            const auto gpa = vmm::memory::detail::GuestAddress{addr};
+            const auto* region = memory.find_region(gpa);
+
+            if (region == nullptr)
+                return result;
+
+            if (result.count == capacity)
+                return result;
+
+            const auto room = region->size() - (addr - region->start().data());
+            const auto chunk = std::min(remaining, room);
+
+            iov[result.count] = iovec{region->get_host_address(gpa),
+                                      static_cast<std::size_t>(chunk)};
+            result.count++;
+
+            if (!writable)
+                result.readable++;
+
+            addr += chunk;
+            remaining -= chunk;
+        }
+    }
+
+    result.ok = true;
+
+    return result;
+}
+
+}  // namespace vmm::virtio::detail
@@ -6,9 +6,281 @@
 
 namespace vmm::virtio::detail {
 
+namespace {
+
+// The driver and device run on different cores; ring indices are published
+// with release stores and observed with acquire loads so that ring contents
+// are ordered with respect to the index that announces them.
+auto load_acquire(const uint16_t* ptr) noexcept -> uint16_t
+{
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+auto store_release(uint16_t* ptr, uint16_t val) noexcept -> void
+{
+    __atomic_store_n(ptr, val, __ATOMIC_RELEASE);
+}
+
+}  // namespace
+
 auto Descriptor::addr() const noexcept -> GuestAddress
 {
     return m_addr;
 }
 
+DescriptorChain::DescriptorChain(const VirtqDesc* table, uint16_t queue_size,
+                                 uint16_t head,
+                                 const Translator* translate) noexcept
+    : m_table{table},
+      m_translate{translate},
+      m_table_size{queue_size},
+      m_head{head},
+      m_ttl{queue_size}
+{
+    if (head < queue_size && m_ttl > 0) {
+        m_desc = &m_table[head];
+        descend();
+    }
+}
+
+auto DescriptorChain::descend() noexcept -> void
+{
+    if (!m_desc->is_indirect() || m_translate == nullptr || !*m_translate)
+        return;
+
+    const auto n = m_desc->len / sizeof(VirtqDesc);
+    const auto table = (*m_translate)(m_desc->addr, m_desc->len);
+
+    if (table == nullptr || n == 0) {
+        m_desc = nullptr;
+        return;
+    }
+
+    m_table = static_cast<const VirtqDesc*>(table);
+    m_table_size = static_cast<uint16_t>(n);
+    m_desc = m_table;
+}
+
+auto DescriptorChain::operator++() noexcept -> DescriptorChain&
+{
+    if (m_desc == nullptr)
+        return *this;
+
+    if (!m_desc->has_next() || --m_ttl == 0) {
+        m_desc = nullptr;
+        return *this;
+    }
+
+    if (const auto next = m_desc->next; next < m_table_size) {
+        m_desc = &m_table[next];
+        descend();
+    }
+    else {
+        m_desc = nullptr;
+    }
+
+    return *this;
+}
+
+VirtQueue::VirtQueue(uint16_t size, void* desc, void* avail, void* used,
+                     Translator translate)
+    : m_desc{static_cast<VirtqDesc*>(desc)},
+      m_avail{static_cast<VirtqAvail*>(avail)},
+      m_used{static_cast<VirtqUsed*>(used)},
+      m_translate{std::move(translate)},
+      m_size{size}
+{
+}
+
+auto VirtQueue::avail_entry(uint16_t idx) const noexcept -> uint16_t
+{
+    // The available ring's entries immediately follow its header.
+    return reinterpret_cast<const uint16_t*>(m_avail + 1)[idx];
+}
+
+auto VirtQueue::used_elem(uint16_t idx) noexcept -> VirtqUsedElem&
+{
+    // The used ring's elements immediately follow its header.
+    return static_cast<VirtqUsedElem*>(static_cast<void*>(m_used + 1))[idx];
+}
+
+auto VirtQueue::avail_idx() const noexcept -> uint16_t
+{
+    return load_acquire(&m_avail->idx);
+}
+
+auto VirtQueue::has_avail() const noexcept -> bool
+{
+    return m_next_avail != avail_idx();
+}
+
+auto VirtQueue::pop() noexcept -> DescriptorChain
+{
+    if (!has_avail())
+        return DescriptorChain{};
+
+    const auto head = avail_entry(m_next_avail % m_size);
+    m_next_avail++;
+
+    return DescriptorChain{m_desc, m_size, head, &m_translate};
+}
+
+auto VirtQueue::add_used(uint16_t head, uint32_t len) noexcept -> void
+{
+    auto& elem = used_elem(static_cast<uint16_t>(m_used_idx + m_pending_used) % m_size);
+    elem.id = head;
+    elem.len = len;
+    m_pending_used++;
+}
+
+auto VirtQueue::publish_used() noexcept -> void
+{
+    if (m_pending_used == 0)
+        return;
+
+    m_used_idx = static_cast<uint16_t>(m_used_idx + m_pending_used);
+    m_pending_used = 0;
+    store_release(&m_used->idx, m_used_idx);
+}
+
+auto VirtQueue::used_event() const noexcept -> const uint16_t*
+{
+    // le16 used_event, immediately after the available ring's entries.
+    return reinterpret_cast<const uint16_t*>(m_avail + 1) + m_size;
+}
+
+auto VirtQueue::avail_event() noexcept -> uint16_t*
+{
+    // le16 avail_event, immediately after the used ring's elements.
+    return reinterpret_cast<uint16_t*>(
+            static_cast<VirtqUsedElem*>(static_cast<void*>(m_used + 1)) +
+            m_size);
+}
+
+auto VirtQueue::set_event_idx(bool enabled) noexcept -> void
+{
+    m_event_idx = enabled;
+}
+
+auto VirtQueue::needs_notification() noexcept -> bool
+{
+    if (!m_event_idx) {
+        // VIRTQ_AVAIL_F_NO_INTERRUPT: a best-effort hint, read unordered.
+        return (m_avail->flags & 1u) == 0;
+    }
+
+    // The driver wants an interrupt only when `used_event` is crossed:
+    // notify iff used_event is in (m_signalled_used, m_used_idx], computed
+    // on free-running indices so ring wraparound falls out naturally.
+    const auto event = load_acquire(used_event());
+    const auto needed = static_cast<uint16_t>(m_used_idx - event - 1) <
+                        static_cast<uint16_t>(m_used_idx - m_signalled_used);
+
+    m_signalled_used = m_used_idx;
+    return needed;
+}
+
+auto VirtQueue::update_avail_event() noexcept -> void
+{
+    if (!m_event_idx)
+        return;
+
+    store_release(avail_event(), m_next_avail);
+}
+
+PackedVirtQueue::PackedVirtQueue(uint16_t size, void* ring,
+                                 Translator translate)
+    : m_ring{static_cast<VirtqPackedDesc*>(ring)},
+      m_translate{std::move(translate)},
+      m_size{size}
+{
+    m_pending.reserve(size);
+}
+
+auto PackedVirtQueue::is_avail(uint16_t flags) const noexcept -> bool
+{
+    const auto avail = (flags & (1u << static_cast<uint16_t>(VirtqueueDescriptorFlag::Avail))) != 0;
+    const auto used = (flags & (1u << static_cast<uint16_t>(VirtqueueDescriptorFlag::Used))) != 0;
+
+    return avail == m_avail_wrap && used != m_avail_wrap;
+}
+
+auto PackedVirtQueue::has_avail() const noexcept -> bool
+{
+    return is_avail(load_acquire(&m_ring[m_next_avail].flags));
+}
+
+auto PackedVirtQueue::pop() noexcept -> PackedDescriptorChain
+{
+    // The driver writes a chain's descriptors first and flips the head
+    // descriptor's avail bit last, so one acquire load of the head flags
+    // makes the whole chain visible.
+    if (!is_avail(load_acquire(&m_ring[m_next_avail].flags)))
+        return PackedDescriptorChain{};
+
+    auto slot = m_next_avail;
+    auto count = uint16_t{1};
+
+    while (m_ring[slot].has_next() && count < m_size) {
+        slot = static_cast<uint16_t>((slot + 1) % m_size);
+        count++;
+    }
+
+    const auto chain = PackedDescriptorChain{m_ring, m_size, m_next_avail,
+                                             count, m_ring[slot].id};
+
+    m_next_avail = static_cast<uint16_t>(m_next_avail + count);
+
+    if (m_next_avail >= m_size) {
+        m_next_avail = static_cast<uint16_t>(m_next_avail - m_size);
+        m_avail_wrap = !m_avail_wrap;
+    }
+
+    return chain;
+}
+
+auto PackedVirtQueue::add_used(uint16_t id, uint32_t len, uint16_t count) -> void
+{
+    m_pending.push_back({m_next_used, id, len, m_used_wrap});
+
+    // A single used descriptor stands in for the whole chain; the driver
+    // advances its used index by the chain's slot count.
+    m_next_used = static_cast<uint16_t>(m_next_used + count);
+
+    if (m_next_used >= m_size) {
+        m_next_used = static_cast<uint16_t>(m_next_used - m_size);
+        m_used_wrap = !m_used_wrap;
+    }
+}
+
+auto PackedVirtQueue::write_used(const PendingUsed& pending) noexcept -> uint16_t
+{
+    auto& desc = m_ring[pending.slot];
+    desc.id = pending.id;
+    desc.len = pending.len;
+
+    constexpr auto wrap_bits =
+        static_cast<uint16_t>((1u << static_cast<uint16_t>(VirtqueueDescriptorFlag::Avail)) |
+                              (1u << static_cast<uint16_t>(VirtqueueDescriptorFlag::Used)));
+
+    return pending.wrap ? wrap_bits : uint16_t{0};
+}
+
+auto PackedVirtQueue::publish_used() noexcept -> void
+{
+    if (m_pending.empty())
+        return;
+
+    // Completions after the first become visible together with the first,
+    // so their flags can be plain stores; the head completion's flags are
+    // stored last with the batch's one release barrier.
+    for (auto it = m_pending.begin() + 1; it != m_pending.end(); ++it)
+        m_ring[it->slot].flags = write_used(*it);
+
+    const auto head_flags = write_used(m_pending.front());
+    store_release(&m_ring[m_pending.front().slot].flags, head_flags);
+
+    m_pending.clear();
+}
+
 }  // namespace vmm::virtio::detail
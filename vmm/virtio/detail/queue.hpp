@@ -5,15 +5,29 @@
 #pragma once
 
 #include <bitset> // bitset
+#include <cstddef> // ptrdiff_t, size_t
 #include <cstdint> // uint*_t
+#include <functional> // function
 #include <iostream> // ostream
+#include <iterator> // forward_iterator_tag
+#include <vector> // vector
+
+#include "vmm/memory/detail/guest.hpp" // is_byte_valued_v
 
 namespace vmm::virtio::detail {
 
+// Maximum number of descriptors in a virtqueue (2^15).
+constexpr uint16_t VIRTQUEUE_MAX_SIZE = 32768;
+
 enum class VirtqueueDescriptorFlag : uint16_t {
     Next,
     Write,
     Indirect,
+
+    // Packed-ring only (VIRTIO_F_RING_PACKED): availability is signalled
+    // in-band via the avail/used bits rather than separate rings.
+    Avail = 7,
+    Used = 15,
 };
 
 class GuestAddress
@@ -33,10 +47,6 @@ class GuestAddress
 
 // Virtio descriptor constraints with C representation
 //
-// TODO:
-//
-//  * Implement ByteValued interface.
-//
 // REFERENCE:
 //
 //     #define VIRTQ_DESC_F_NEXT       1 // Marks a buffer as continuing via the `next` field.
@@ -115,8 +125,508 @@ class Descriptor
         }
 };
 
-struct VirtQueue
+// A split virtqueue descriptor table entry, read in place from guest memory.
+//
+// REFERENCE:
+//
+//     struct virtq_desc {
+//         le64 addr;
+//         le32 len;
+//         le16 flags;
+//         le16 next;
+//     };
+struct VirtqDesc
+{
+    uint64_t addr;
+    uint32_t len;
+    uint16_t flags;
+    uint16_t next;
+
+    [[nodiscard]] constexpr auto has_next() const noexcept -> bool
+    {
+        return flags & (1u << static_cast<uint16_t>(VirtqueueDescriptorFlag::Next));
+    }
+
+    [[nodiscard]] constexpr auto is_write_only() const noexcept -> bool
+    {
+        return flags & (1u << static_cast<uint16_t>(VirtqueueDescriptorFlag::Write));
+    }
+
+    [[nodiscard]] constexpr auto is_indirect() const noexcept -> bool
+    {
+        return flags & (1u << static_cast<uint16_t>(VirtqueueDescriptorFlag::Indirect));
+    }
+};
+
+// The fixed-size header of a split virtqueue available ring. The ring entries
+// (le16 each) immediately follow the header in guest memory.
+//
+// REFERENCE:
+//
+//     struct virtq_avail {
+//         le16 flags;
+//         le16 idx;
+//         le16 ring[ /* Queue Size */ ];
+//     };
+struct VirtqAvail
+{
+    uint16_t flags;
+    uint16_t idx;
+};
+
+// A single element of a split virtqueue used ring.
+struct VirtqUsedElem
+{
+    uint32_t id;
+    uint32_t len;
+};
+
+// The fixed-size header of a split virtqueue used ring. The used elements
+// immediately follow the header in guest memory.
+//
+// REFERENCE:
+//
+//     struct virtq_used {
+//         le16 flags;
+//         le16 idx;
+//         struct virtq_used_elem ring[ /* Queue Size */ ];
+//     };
+struct VirtqUsed
+{
+    uint16_t flags;
+    uint16_t idx;
+};
+
+// A packed virtqueue descriptor ring entry, read in place from guest memory.
+//
+// Unlike the split layout, a packed descriptor carries its buffer id and the
+// avail/used wrap bits inline, so driver, device, and completion state for an
+// element all live in the same cache line.
+//
+// REFERENCE:
+//
+//     struct pvirtq_desc {
+//         le64 addr;
+//         le32 len;
+//         le16 id;
+//         le16 flags;
+//     };
+struct VirtqPackedDesc
+{
+    uint64_t addr;
+    uint32_t len;
+    uint16_t id;
+    uint16_t flags;
+
+    [[nodiscard]] constexpr auto has_next() const noexcept -> bool
+    {
+        return flags & (1u << static_cast<uint16_t>(VirtqueueDescriptorFlag::Next));
+    }
+
+    [[nodiscard]] constexpr auto is_write_only() const noexcept -> bool
+    {
+        return flags & (1u << static_cast<uint16_t>(VirtqueueDescriptorFlag::Write));
+    }
+
+    [[nodiscard]] constexpr auto avail_bit() const noexcept -> bool
+    {
+        return flags & (1u << static_cast<uint16_t>(VirtqueueDescriptorFlag::Avail));
+    }
+
+    [[nodiscard]] constexpr auto used_bit() const noexcept -> bool
+    {
+        return flags & (1u << static_cast<uint16_t>(VirtqueueDescriptorFlag::Used));
+    }
+};
+
+// The ring structures are accessed in place in guest memory (and through
+// GuestMemory::read_obj()/write_obj()); byte-valuedness guarantees their
+// object representation is exactly the wire layout the virtio spec mandates.
+static_assert(vmm::memory::detail::is_byte_valued_v<VirtqDesc>);
+static_assert(vmm::memory::detail::is_byte_valued_v<VirtqAvail>);
+static_assert(vmm::memory::detail::is_byte_valued_v<VirtqUsedElem>);
+static_assert(vmm::memory::detail::is_byte_valued_v<VirtqUsed>);
+static_assert(vmm::memory::detail::is_byte_valued_v<VirtqPackedDesc>);
+
+// A forward iterator over a guest's descriptor chain.
+//
+// The iterator hands out references into the guest's descriptor table rather
+// than copies; device emulation reads `addr`, `len`, and the flags straight
+// from guest memory. Indirect descriptor tables are entered transparently via
+// the owning queue's address translation callback.
+//
+// A default-constructed chain acts as the past-the-end iterator. Malformed
+// chains (out-of-range `next` links, loops longer than the queue size) simply
+// terminate early rather than walking out of bounds.
+class DescriptorChain
+{
+    public:
+        using value_type = VirtqDesc;
+        using reference = const VirtqDesc&;
+        using pointer = const VirtqDesc*;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::forward_iterator_tag;
+
+        using Translator = std::function<void*(uint64_t addr, uint32_t len)>;
+
+        DescriptorChain() noexcept = default;
+
+        DescriptorChain(const VirtqDesc* table, uint16_t queue_size,
+                        uint16_t head, const Translator* translate) noexcept;
+
+        [[nodiscard]] auto operator*() const noexcept -> reference
+        {
+            return *m_desc;
+        }
+
+        [[nodiscard]] auto operator->() const noexcept -> pointer
+        {
+            return m_desc;
+        }
+
+        // Returns the index of the chain's head descriptor. Used-ring
+        // publication identifies the chain by this value.
+        [[nodiscard]] constexpr auto head() const noexcept -> uint16_t
+        {
+            return m_head;
+        }
+
+        auto operator++() noexcept -> DescriptorChain&;
+
+        auto operator++(int) noexcept -> DescriptorChain
+        {
+            auto copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        [[nodiscard]] explicit operator bool() const noexcept
+        {
+            return m_desc != nullptr;
+        }
+
+        [[nodiscard]] auto operator==(const DescriptorChain& other) const noexcept -> bool
+        {
+            return m_desc == other.m_desc;
+        }
+
+        [[nodiscard]] auto operator!=(const DescriptorChain& other) const noexcept -> bool
+        {
+            return !(*this == other);
+        }
+
+        // Range support so chains work with range-based for loops.
+        [[nodiscard]] auto begin() const noexcept -> DescriptorChain
+        {
+            return *this;
+        }
+
+        [[nodiscard]] auto end() const noexcept -> DescriptorChain
+        {
+            return DescriptorChain{};
+        }
+    private:
+        const VirtqDesc* m_table{};
+        const VirtqDesc* m_desc{};
+        const Translator* m_translate{};
+        uint16_t m_table_size{};
+        uint16_t m_head{};
+
+        // Remaining descriptors before the chain is considered looped.
+        uint16_t m_ttl{};
+
+        // Enters an indirect descriptor table if the current descriptor
+        // requests one and a translation callback is available.
+        auto descend() noexcept -> void;
+};
+
+// A split ("legacy") virtqueue.
+//
+// The queue operates directly on the guest's descriptor table, available
+// ring, and used ring; the constructor takes host addresses for all three.
+// Under a live memslot layout, resolve those addresses through
+// PinnedRegion handles and rebuild the queue when a handle re-resolves —
+// ring index reads then stay raw pointer dereferences on every
+// notification.
+// Completions written with `add_used()` go straight into the used ring but
+// are not visible to the driver until `publish_used()` stores the ring index
+// with a single release barrier, so a batch of completions costs one barrier
+// total rather than one per element.
+class VirtQueue
 {
+    public:
+        using Translator = DescriptorChain::Translator;
+
+        VirtQueue() = default;
+
+        VirtQueue(uint16_t size, void* desc, void* avail, void* used,
+                  Translator translate={});
+
+        [[nodiscard]] constexpr auto size() const noexcept -> uint16_t
+        {
+            return m_size;
+        }
+
+        // Returns the driver's current available-ring index (acquire load).
+        [[nodiscard]] auto avail_idx() const noexcept -> uint16_t;
+
+        // Checks whether the driver has queued descriptors we have not
+        // popped yet.
+        [[nodiscard]] auto has_avail() const noexcept -> bool;
+
+        // Pops the next available descriptor chain. Returns an end (empty)
+        // chain if the driver has not queued anything new.
+        [[nodiscard]] auto pop() noexcept -> DescriptorChain;
+
+        // Writes a completed chain into the used ring without publishing it.
+        auto add_used(uint16_t head, uint32_t len) noexcept -> void;
+
+        // Publishes all pending used elements to the driver with a single
+        // release barrier.
+        auto publish_used() noexcept -> void;
+
+        // Enables VIRTIO_F_EVENT_IDX handling, turning on the `used_event`
+        // and `avail_event` fields at the tails of the rings. Called once
+        // at feature negotiation time, before the queue is serviced.
+        auto set_event_idx(bool enabled) noexcept -> void;
+
+        // Checks whether the driver asked to be interrupted for the used
+        // elements published since the last call. Without EVENT_IDX this
+        // honors the driver's NO_INTERRUPT hint; with it, the driver's
+        // `used_event` index is compared against the published range, so a
+        // driver that is actively polling the used ring receives no
+        // interrupts at all. Call after `publish_used()`.
+        [[nodiscard]] auto needs_notification() noexcept -> bool;
+
+        // Publishes how far the device has consumed the available ring
+        // (EVENT_IDX's `avail_event`), telling the driver not to kick again
+        // until it has queued descriptors past that point. Calling this on
+        // each service pass while busy-polling suppresses nearly every
+        // guest exit under load; without EVENT_IDX it is a no-op.
+        auto update_avail_event() noexcept -> void;
+
+        // Host addresses of the ring structures, as handed to the
+        // constructor. A vhost backend programs these into the kernel,
+        // which then accesses the rings through this process's mappings.
+        [[nodiscard]] constexpr auto desc_table() const noexcept -> const VirtqDesc*
+        {
+            return m_desc;
+        }
+
+        [[nodiscard]] constexpr auto avail_ring() const noexcept -> const VirtqAvail*
+        {
+            return m_avail;
+        }
+
+        [[nodiscard]] constexpr auto used_ring() const noexcept -> const VirtqUsed*
+        {
+            return m_used;
+        }
+
+        // Returns the next available-ring index the device will consume; a
+        // vhost handoff resumes the kernel side from this point
+        // (VHOST_SET_VRING_BASE).
+        [[nodiscard]] constexpr auto next_avail() const noexcept -> uint16_t
+        {
+            return m_next_avail;
+        }
+    private:
+        VirtqDesc* m_desc{};
+        VirtqAvail* m_avail{};
+        VirtqUsed* m_used{};
+        Translator m_translate{};
+
+        uint16_t m_size{};
+
+        // Free-running shadow of the last available-ring index we consumed.
+        uint16_t m_next_avail{};
+
+        // Free-running shadow of the published used-ring index.
+        uint16_t m_used_idx{};
+
+        // Used elements written to the ring but not yet published.
+        uint16_t m_pending_used{};
+
+        // Whether VIRTIO_F_EVENT_IDX was negotiated.
+        bool m_event_idx = false;
+
+        // The used index as of the last notification decision; the driver
+        // is notified only if its `used_event` falls inside
+        // (m_signalled_used, m_used_idx].
+        uint16_t m_signalled_used{};
+
+        [[nodiscard]] auto avail_entry(uint16_t idx) const noexcept -> uint16_t;
+        [[nodiscard]] auto used_elem(uint16_t idx) noexcept -> VirtqUsedElem&;
+
+        // EVENT_IDX fields: `used_event` trails the available ring and
+        // `avail_event` trails the used ring.
+        [[nodiscard]] auto used_event() const noexcept -> const uint16_t*;
+        [[nodiscard]] auto avail_event() noexcept -> uint16_t*;
+};
+
+// A forward iterator over a packed-ring descriptor chain.
+//
+// Packed chains occupy consecutive ring slots, so iteration is a bounded
+// walk with wraparound instead of pointer chasing. Like DescriptorChain, the
+// iterator hands out references into guest memory rather than copies, and a
+// default-constructed chain acts as the past-the-end iterator.
+class PackedDescriptorChain
+{
+    public:
+        using value_type = VirtqPackedDesc;
+        using reference = const VirtqPackedDesc&;
+        using pointer = const VirtqPackedDesc*;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::forward_iterator_tag;
+
+        PackedDescriptorChain() noexcept = default;
+
+        PackedDescriptorChain(const VirtqPackedDesc* ring, uint16_t ring_size,
+                              uint16_t slot, uint16_t count,
+                              uint16_t id) noexcept
+            : m_ring{ring}, m_ring_size{ring_size}, m_slot{slot},
+              m_remaining{count}, m_id{id} {}
+
+        [[nodiscard]] auto operator*() const noexcept -> reference
+        {
+            return m_ring[m_slot];
+        }
+
+        [[nodiscard]] auto operator->() const noexcept -> pointer
+        {
+            return &m_ring[m_slot];
+        }
+
+        // Returns the chain's buffer id (carried by its last descriptor).
+        // Used-ring publication identifies the chain by this value.
+        [[nodiscard]] constexpr auto id() const noexcept -> uint16_t
+        {
+            return m_id;
+        }
+
+        // Returns the number of ring slots the chain still covers.
+        [[nodiscard]] constexpr auto remaining() const noexcept -> uint16_t
+        {
+            return m_remaining;
+        }
+
+        auto operator++() noexcept -> PackedDescriptorChain&
+        {
+            if (m_remaining > 0 && --m_remaining > 0)
+                m_slot = static_cast<uint16_t>((m_slot + 1) % m_ring_size);
+
+            return *this;
+        }
+
+        auto operator++(int) noexcept -> PackedDescriptorChain
+        {
+            auto copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        [[nodiscard]] explicit operator bool() const noexcept
+        {
+            return m_remaining != 0;
+        }
+
+        [[nodiscard]] auto operator==(const PackedDescriptorChain& other) const noexcept -> bool
+        {
+            return m_remaining == other.m_remaining &&
+                   (m_remaining == 0 || (m_ring == other.m_ring &&
+                                         m_slot == other.m_slot));
+        }
+
+        [[nodiscard]] auto operator!=(const PackedDescriptorChain& other) const noexcept -> bool
+        {
+            return !(*this == other);
+        }
+
+        [[nodiscard]] auto begin() const noexcept -> PackedDescriptorChain
+        {
+            return *this;
+        }
+
+        [[nodiscard]] auto end() const noexcept -> PackedDescriptorChain
+        {
+            return PackedDescriptorChain{};
+        }
+    private:
+        const VirtqPackedDesc* m_ring{};
+        uint16_t m_ring_size{};
+        uint16_t m_slot{};
+        uint16_t m_remaining{};
+        uint16_t m_id{};
+};
+
+// A packed virtqueue (VIRTIO_F_RING_PACKED).
+//
+// The packed layout replaces the three split rings with a single descriptor
+// ring; availability and completion are signalled through per-descriptor
+// avail/used bits checked against wrap counters. The interface mirrors
+// VirtQueue (pop/add_used/publish_used) so device code can service either
+// ring format, selected at feature negotiation time.
+//
+// As with VirtQueue, completions recorded with `add_used()` stay invisible
+// to the driver until `publish_used()` flips the head descriptor's flags
+// with a single release store per batch.
+class PackedVirtQueue
+{
+    public:
+        using Translator = DescriptorChain::Translator;
+
+        PackedVirtQueue() = default;
+
+        PackedVirtQueue(uint16_t size, void* ring, Translator translate={});
+
+        [[nodiscard]] constexpr auto size() const noexcept -> uint16_t
+        {
+            return m_size;
+        }
+
+        // Checks whether the driver has made descriptors available that we
+        // have not popped yet.
+        [[nodiscard]] auto has_avail() const noexcept -> bool;
+
+        // Pops the next available descriptor chain. Returns an end (empty)
+        // chain if the driver has not queued anything new.
+        [[nodiscard]] auto pop() noexcept -> PackedDescriptorChain;
+
+        // Records a completed chain without publishing it. `count` is the
+        // number of ring slots the chain covered.
+        auto add_used(uint16_t id, uint32_t len, uint16_t count=1) -> void;
+
+        // Publishes all pending completions. The head completion's flags are
+        // stored last, with a single release barrier for the whole batch.
+        auto publish_used() noexcept -> void;
+    private:
+        struct PendingUsed
+        {
+            uint16_t slot;
+            uint16_t id;
+            uint32_t len;
+            bool wrap;
+        };
+
+        VirtqPackedDesc* m_ring{};
+        Translator m_translate{};
+        std::vector<PendingUsed> m_pending{};
+
+        uint16_t m_size{};
+
+        // Next ring slot to examine for an available descriptor, with the
+        // wrap counter the avail bit must match.
+        uint16_t m_next_avail{};
+        bool m_avail_wrap = true;
+
+        // Next ring slot completions are written to, with the device's wrap
+        // counter.
+        uint16_t m_next_used{};
+        bool m_used_wrap = true;
+
+        [[nodiscard]] auto is_avail(uint16_t flags) const noexcept -> bool;
+
+        auto write_used(const PendingUsed&) noexcept -> uint16_t;
 };
 
 }  // namespace vmm::virtio::detail
@@ -0,0 +1,70 @@
+//
+// servicer.hpp - Busy-poll virtqueue servicing
+//
+
+#pragma once
+
+#include <chrono> // microseconds
+#include <cstdint> // uint64_t
+
+#include "vmm/types/event.hpp"
+#include "vmm/virtio/detail/queue.hpp"
+
+namespace vmm::virtio::detail {
+
+// Waits for virtqueue work by spinning before sleeping.
+//
+// An eventfd wakeup (epoll_wait -> read -> process) costs 5-10us on top of
+// the kick itself; on a core dedicated to device emulation that dwarfs the
+// cost of servicing the ring. The servicer makes the same trade as
+// vhost-net's busyloop: spin on the available-ring index for a configurable
+// budget and only fall back to a blocking read of the kick eventfd when the
+// budget runs out. Under load every wait is satisfied by the poll and the
+// eventfd never enters the picture; an idle queue parks on the eventfd and
+// costs nothing.
+//
+// Per-queue counters record how each wait was resolved so deployments can
+// size the budget: a high miss share says the budget is burning CPU for
+// nothing, a high hit share with many spins says it could shrink.
+class QueueServicer
+{
+    public:
+        struct Stats
+        {
+            // Waits satisfied while spinning.
+            uint64_t poll_hits;
+
+            // Waits that exhausted the budget and fell back to the
+            // eventfd.
+            uint64_t poll_misses;
+
+            // Blocking eventfd wakeups (including stale kicks).
+            uint64_t wakeups;
+
+            // Total spin iterations across all waits.
+            uint64_t spins;
+        };
+
+        // `kick` is the queue's kick eventfd, i.e. `BoundQueue::kick`. A
+        // zero budget disables polling entirely.
+        QueueServicer(VirtQueue& queue, const vmm::types::EventFd& kick,
+                      std::chrono::microseconds budget);
+
+        // Blocks until the driver has queued descriptors, spinning for up
+        // to the poll budget first.
+        auto wait() -> void;
+
+        auto set_poll_budget(std::chrono::microseconds budget) noexcept -> void;
+
+        [[nodiscard]] auto poll_budget() const noexcept
+            -> std::chrono::microseconds;
+
+        [[nodiscard]] auto stats() const noexcept -> Stats;
+    private:
+        VirtQueue& m_queue;
+        vmm::types::EventFd m_kick;
+        std::chrono::microseconds m_budget;
+        Stats m_stats{};
+};
+
+}  // namespace vmm::virtio::detail
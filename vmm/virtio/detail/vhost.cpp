@@ -0,0 +1,113 @@
+//
+// vhost.cpp - Vhost kernel offload
+//
+
+#include <vector> // vector
+
+#include <fcntl.h> // open, O_RDWR, O_CLOEXEC
+
+// The legacy helpers in <linux/virtio_ring.h> (pulled in via vhost.h) are
+// C-only; the ioctl interface needs none of them.
+#define VIRTIO_RING_NO_LEGACY
+#include <linux/vhost.h> // vhost_*, VHOST_*
+
+#include "vmm/virtio/detail/vhost.hpp"
+#include "vmm/types/detail/exceptions.hpp"
+
+namespace vmm::virtio::detail {
+
+namespace {
+
+[[nodiscard]] auto open_vhost(const char* path) -> int
+{
+    const auto fd = ::open(path, O_RDWR | O_CLOEXEC);
+
+    if (fd < 0)
+        VMM_THROW(std::system_error(errno, std::system_category()));
+
+    return fd;
+}
+
+[[nodiscard]] auto user_addr(const void* ptr) noexcept -> uint64_t
+{
+    return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(ptr));
+}
+
+}  // namespace
+
+VhostDevice::VhostDevice(const char* path)
+    : vmm::types::FileDescriptor{open_vhost(path)}
+{
+    // Claims the device for this process; every subsequent ioctl requires
+    // an owner.
+    ioctl(VHOST_SET_OWNER);
+}
+
+auto VhostDevice::features() const -> uint64_t
+{
+    auto features = uint64_t{};
+    ioctl(VHOST_GET_FEATURES, &features);
+    return features;
+}
+
+auto VhostDevice::set_features(uint64_t features) const -> void
+{
+    ioctl(VHOST_SET_FEATURES, &features);
+}
+
+auto VhostDevice::set_mem_table(const vmm::memory::detail::GuestMemory& memory) const -> void
+{
+    // vhost_memory ends in a flexible array member; build the table in one
+    // allocation sized for the region count.
+    auto buffer = std::vector<unsigned char>(
+        sizeof(vhost_memory) +
+        memory.size() * sizeof(vhost_memory_region));
+
+    const auto table = reinterpret_cast<vhost_memory*>(buffer.data());
+    table->nregions = static_cast<uint32_t>(memory.size());
+
+    for (auto i = std::size_t{}; i < memory.size(); i++) {
+        const auto& region = memory.region(i);
+
+        table->regions[i].guest_phys_addr = region.start().data();
+        table->regions[i].memory_size = region.size();
+        table->regions[i].userspace_addr = user_addr(region.data());
+        table->regions[i].flags_padding = 0;
+    }
+
+    ioctl(VHOST_SET_MEM_TABLE, table);
+}
+
+auto VhostDevice::setup_vring(uint32_t index, const VirtQueue& queue,
+                              const vmm::types::EventFd& kick,
+                              const vmm::types::EventFd& call) const -> void
+{
+    auto state = vhost_vring_state{index, queue.size()};
+    ioctl(VHOST_SET_VRING_NUM, &state);
+
+    // Resume the kernel side from wherever the userspace queue stopped
+    // consuming, so a mid-flight handoff drops nothing.
+    state.num = queue.next_avail();
+    ioctl(VHOST_SET_VRING_BASE, &state);
+
+    auto addr = vhost_vring_addr{};
+    addr.index = index;
+    addr.desc_user_addr = user_addr(queue.desc_table());
+    addr.avail_user_addr = user_addr(queue.avail_ring());
+    addr.used_user_addr = user_addr(queue.used_ring());
+    ioctl(VHOST_SET_VRING_ADDR, &addr);
+
+    auto file = vhost_vring_file{index, kick.fd()};
+    ioctl(VHOST_SET_VRING_KICK, &file);
+
+    file.fd = call.fd();
+    ioctl(VHOST_SET_VRING_CALL, &file);
+}
+
+auto VhostNet::set_backend(uint32_t index, int tap) const -> void
+{
+    auto backend = vhost_vring_file{index, tap};
+    ioctl(VHOST_NET_SET_BACKEND, &backend);
+}
+
+}  // namespace vmm::virtio::detail
@@ -0,0 +1,67 @@
+//
+// vhost.hpp - Vhost kernel offload
+//
+
+#pragma once
+
+#include <cstdint> // uint*_t
+
+#include "vmm/memory/detail/guest.hpp"
+#include "vmm/types/event.hpp"
+#include "vmm/types/file_descriptor.hpp"
+#include "vmm/virtio/detail/queue.hpp"
+
+namespace vmm::virtio::detail {
+
+// A vhost character-device backend (/dev/vhost-net, /dev/vhost-vsock).
+//
+// vhost moves a virtqueue's data plane into the kernel: userspace programs
+// the guest memory table plus each ring's size, addresses, base index, and
+// kick/call eventfds once, and the kernel then consumes descriptors and
+// raises interrupts with no userspace transition per packet. Userspace
+// keeps handling only control-plane changes — feature negotiation, memory
+// hotplug, queue resets.
+//
+// The kick and call eventfds are the ones already wired through
+// `Vm::attach_ioevent()` and `Vm::register_irqfd()`, so a guest kick lands
+// in the vhost worker and a vhost completion interrupts the guest without
+// the VMM on either path.
+class VhostDevice : public vmm::types::FileDescriptor
+{
+    public:
+        // Opens the device and claims it for this process
+        // (VHOST_SET_OWNER).
+        explicit VhostDevice(const char* path);
+
+        // Returns the feature bits the kernel backend supports.
+        [[nodiscard]] auto features() const -> uint64_t;
+
+        // Sets the negotiated feature subset; call before the rings are
+        // programmed.
+        auto set_features(uint64_t features) const -> void;
+
+        // Programs the guest memory table: one vhost region per
+        // GuestMemoryRegion, mapping the guest-physical ranges handed to
+        // `Vm::set_memslot()` to this process's mappings.
+        auto set_mem_table(const vmm::memory::detail::GuestMemory& memory) const -> void;
+
+        // Programs one virtqueue into the kernel: ring size and addresses,
+        // the available index to resume consuming from, and the kick/call
+        // eventfds.
+        auto setup_vring(uint32_t index, const VirtQueue& queue,
+                         const vmm::types::EventFd& kick,
+                         const vmm::types::EventFd& call) const -> void;
+};
+
+// The /dev/vhost-net device.
+class VhostNet : public VhostDevice
+{
+    public:
+        VhostNet() : VhostDevice{"/dev/vhost-net"} {}
+
+        // Attaches a tap/macvtap fd as the backend of vring `index`; the
+        // kernel starts moving packets once both ends are in place.
+        auto set_backend(uint32_t index, int tap) const -> void;
+};
+
+}  // namespace vmm::virtio::detail
@@ -5,14 +5,36 @@
 #pragma once
 
 #include "vmm/virtio/detail/device.hpp"
+#include "vmm/virtio/detail/iovec.hpp"
 #include "vmm/virtio/detail/queue.hpp"
+#include "vmm/virtio/detail/servicer.hpp"
+#include "vmm/virtio/detail/vhost.hpp"
 
 namespace vmm::virtio {
 
 using VirtDevice = vmm::virtio::detail::VirtDevice;
 using VirtQueue = vmm::virtio::detail::VirtQueue;
+using PackedVirtQueue = vmm::virtio::detail::PackedVirtQueue;
+using QueueServicer = vmm::virtio::detail::QueueServicer;
+using VhostDevice = vmm::virtio::detail::VhostDevice;
+using VhostNet = vmm::virtio::detail::VhostNet;
 
 using GuestAddress = vmm::virtio::detail::GuestAddress;
 using Descriptor = vmm::virtio::detail::Descriptor;
+using DescriptorChain = vmm::virtio::detail::DescriptorChain;
+using PackedDescriptorChain = vmm::virtio::detail::PackedDescriptorChain;
+
+using VirtqDesc = vmm::virtio::detail::VirtqDesc;
+using VirtqPackedDesc = vmm::virtio::detail::VirtqPackedDesc;
+using VirtqAvail = vmm::virtio::detail::VirtqAvail;
+using VirtqUsed = vmm::virtio::detail::VirtqUsed;
+using VirtqUsedElem = vmm::virtio::detail::VirtqUsedElem;
+
+using ChainIovecs = vmm::virtio::detail::ChainIovecs;
+using vmm::virtio::detail::chain_to_iovecs;
+
+using vmm::virtio::detail::VIRTIO_F_EVENT_IDX;
+using vmm::virtio::detail::VIRTIO_F_VERSION_1;
+using vmm::virtio::detail::VIRTIO_F_RING_PACKED;
 
 }  // namespace vmm::virtio